@@ -4,11 +4,38 @@
 #include <iterator>
 #include <stdexcept>
 #include <cassert>
+#include <type_traits>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
 #include "Stack.h"
 #include "Queue.h"
 
 namespace ivlicheva
 {
+  namespace detail
+  {
+    template< typename C, typename = void >
+    struct HasThreeWay: std::false_type
+    {};
+
+    template< typename C >
+    struct HasThreeWay< C, typename C::three_way >: std::true_type
+    {};
+  }
+
+  struct TreeShape
+  {
+    size_t size_;
+    size_t height_;
+    size_t blackHeight_;
+    size_t maxDepth_;
+    double averageDepth_;
+    size_t leftTurns_;
+    size_t rightTurns_;
+  };
+
   template< typename K, typename V, typename C >
   class BinarySearchTree
   {
@@ -54,6 +81,8 @@ namespace ivlicheva
       ConstIterator upperBound(const K&) const;
       ConstIterator lowerBound(const K&) const;
       bool isEmpty() const noexcept;
+      TreeShape shapeStats() const;
+      void validate() const;
 
       Iterator begin();
       Iterator end();
@@ -68,10 +97,18 @@ namespace ivlicheva
       F traverseRNL(F) const;
       template< typename F >
       F traverseBreadth(F) const;
+      template< typename F >
+      F forEachValue(F);
+      template< typename F >
+      F forEachValue(F) const;
+      template< typename F >
+      void parallelForEachValue(F, size_t = 0);
 
     private:
       tree_t* root_;
       tree_t* nil_;
+      size_t leftTurns_;
+      size_t rightTurns_;
       C cmp_;
 
       void destroy();
@@ -101,8 +138,21 @@ namespace ivlicheva
       bool isNil(const tree_t*) const;
       bool isRed(const tree_t*) const;
       bool isBlack(const tree_t*) const;
+      tree_t* getFirstNotLess(const K&) const;
+      tree_t* getFirstGreater(const K&) const;
+      tree_t* getEqual(const K&) const;
+      tree_t* getEqual(const K&, std::true_type) const;
+      tree_t* getEqual(const K&, std::false_type) const;
       bool isLess(const K&, const K&) const;
+      int compare(const K&, const K&) const;
+      int compare(const K&, const K&, std::true_type) const;
+      int compare(const K&, const K&, std::false_type) const;
       bool isEqual(const K&, const K&) const;
+      template< typename G >
+      void visit(tree_t*, G&) const;
+      void collectRoots(tree_t*, size_t, std::vector< tree_t* >&, std::vector< tree_t* >&) const;
+      template< typename G >
+      void runTasks(size_t, size_t, G) const;
   };
   template< typename K, typename V, typename C >
   using BST = BinarySearchTree< K, V, C >;
@@ -348,7 +398,9 @@ typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::Binary
 template< typename K, typename V, typename C >
 ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree():
   root_(nullptr),
-  nil_(static_cast< tree_t* >(operator new(sizeof(tree_t))))
+  nil_(static_cast< tree_t* >(operator new(sizeof(tree_t)))),
+  leftTurns_(0),
+  rightTurns_(0)
 {
   colorize(nil_, 'b');
 }
@@ -376,7 +428,9 @@ ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree(const this_t& ob):
 template< typename K, typename V, typename C >
 ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree(this_t&& ob) noexcept:
   root_(ob.root_),
-  nil_(ob.nil_)
+  nil_(ob.nil_),
+  leftTurns_(ob.leftTurns_),
+  rightTurns_(ob.rightTurns_)
 {
   ob.root_ = nullptr;
   ob.nil_ = nullptr;
@@ -442,31 +496,13 @@ void ivlicheva::BinarySearchTree< K, V, C >::add(tree_t* newLeaf, tree_t* obLeaf
 template< typename K, typename V, typename C >
 size_t ivlicheva::BinarySearchTree< K, V, C >::count(const K& key)
 {
-  auto iter = begin();
-  while (iter != end())
-  {
-    if (isEqual(iter->first, key))
-    {
-      return 1;
-    }
-    ++iter;
-  }
-  return 0;
+  return isNil(getEqual(key)) ? 0 : 1;
 }
 
 template< typename K, typename V, typename C >
 typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::find(const K& key)
 {
-  auto iter = begin();
-  while (iter != end())
-  {
-    if (isEqual(iter->first, key))
-    {
-      break;
-    }
-    ++iter;
-  }
-  return iter;
+  return ConstIterator(getEqual(key), this);
 }
 
 template< typename K, typename V, typename C >
@@ -508,21 +544,19 @@ void ivlicheva::BinarySearchTree< K, V, C >::swap(this_t& ob) noexcept
 {
   std::swap(root_, ob.root_);
   std::swap(nil_, ob.nil_);
+  std::swap(leftTurns_, ob.leftTurns_);
+  std::swap(rightTurns_, ob.rightTurns_);
 }
 
 template< typename K, typename V, typename C >
 const V& ivlicheva::BinarySearchTree< K, V, C >::getElement(const K& key) const
 {
-  auto iter = begin();
-  while (iter != end())
+  tree_t* leaf = getEqual(key);
+  if (isNil(leaf))
   {
-    if (isEqual(iter->first, key))
-    {
-      break;
-    }
-    ++iter;
+    throw std::logic_error("Error in get");
   }
-  return iter->second;
+  return leaf->data_.second;
 }
 
 template< typename K, typename V, typename C >
@@ -635,6 +669,7 @@ void ivlicheva::BinarySearchTree< K, V, C >::turnBigRight(tree_t* leaf)
 template< typename K, typename V, typename C >
 void ivlicheva::BinarySearchTree< K, V, C >::turnSmallLeft(tree_t* leaf)
 {
+  ++leftTurns_;
   if (!isNil(leaf->left_))
   {
     leaf->parent_->right_ = leaf->left_;
@@ -648,9 +683,10 @@ void ivlicheva::BinarySearchTree< K, V, C >::turnSmallLeft(tree_t* leaf)
   if (leaf->parent_->parent_)
   {
     tree_t* tmp = leaf->parent_->parent_;
+    bool isLeftChild = tmp->left_ == leaf->parent_;
     leaf->parent_->parent_ = leaf;
     leaf->parent_ = tmp;
-    if (isLess(leaf->data_.first, tmp->data_.first))
+    if (isLeftChild)
     {
       tmp->left_ = leaf;
     }
@@ -670,6 +706,7 @@ void ivlicheva::BinarySearchTree< K, V, C >::turnSmallLeft(tree_t* leaf)
 template< typename K, typename V, typename C >
 void ivlicheva::BinarySearchTree< K, V, C >::turnSmallRight(tree_t* leaf)
 {
+  ++rightTurns_;
   if (!isNil(leaf->right_))
   {
     leaf->parent_->left_ = leaf->right_;
@@ -683,9 +720,10 @@ void ivlicheva::BinarySearchTree< K, V, C >::turnSmallRight(tree_t* leaf)
   if (leaf->parent_->parent_)
   {
     tree_t* tmp = leaf->parent_->parent_;
+    bool isLeftChild = tmp->left_ == leaf->parent_;
     leaf->parent_->parent_ = leaf;
     leaf->parent_ = tmp;
-    if (isLess(leaf->data_.first, tmp->data_.first))
+    if (isLeftChild)
     {
       tmp->left_ = leaf;
     }
@@ -717,7 +755,7 @@ size_t ivlicheva::BinarySearchTree< K, V, C >::getDepth(tree_t* leaf) const
 template< typename K, typename V, typename C >
 typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getUncle(tree_t* leaf) const
 {
-  if (isLess(leaf->parent_->data_.first, leaf->parent_->parent_->data_.first))
+  if (isLeft(leaf->parent_))
   {
     return leaf->parent_->parent_->right_;
   }
@@ -833,11 +871,11 @@ bool ivlicheva::BinarySearchTree< K, V, C >::isLeft(const tree_t* leaf) const
 template< typename K, typename V, typename C >
 bool ivlicheva::BinarySearchTree< K, V, C >::isInside(const tree_t* leaf) const
 {
-  if (isLess(leaf->parent_->data_.first, leaf->parent_->parent_->data_.first))
+  if (isLeft(leaf->parent_))
   {
-    return !isLess(leaf->data_.first, leaf->parent_->data_.first);
+    return isRight(leaf);
   }
-  return isLess(leaf->data_.first, leaf->parent_->data_.first);
+  return isLeft(leaf);
 }
 
 template< typename K, typename V, typename C >
@@ -869,32 +907,25 @@ typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearc
     root_ = leaf;
     return ConstIterator(leaf, this);
   }
-  tree_t* tmp = root_;
+  tree_t* parent = root_;
+  bool isLeftChild = isLess(k, parent->data_.first);
+  tree_t* tmp = isLeftChild ? parent->left_ : parent->right_;
   while (!isNil(tmp))
   {
-    if (isLess(k, tmp->data_.first))
-    {
-      if (isNil(tmp->left_))
-      {
-        leaf->parent_ = tmp;
-        tmp->left_ = leaf;
-        balancePush(leaf);
-        break;
-      }
-      tmp = tmp->left_;
-    }
-    if (!isLess(k, tmp->data_.first))
-    {
-      if (isNil(tmp->right_))
-      {
-        leaf->parent_ = tmp;
-        tmp->right_ = leaf;
-        balancePush(leaf);
-        break;
-      }
-      tmp = tmp->right_;
-    }
+    parent = tmp;
+    isLeftChild = isLess(k, parent->data_.first);
+    tmp = isLeftChild ? parent->left_ : parent->right_;
+  }
+  leaf->parent_ = parent;
+  if (isLeftChild)
+  {
+    parent->left_ = leaf;
+  }
+  else
+  {
+    parent->right_ = leaf;
   }
+  balancePush(leaf);
   return ConstIterator(leaf, this);
 }
 
@@ -920,23 +951,13 @@ typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearc
 template< typename K, typename V, typename C >
 typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::upperBound(const K& k) const
 {
-  ConstIterator iter = begin();
-  while (iter != end() && isLess(iter.leaf_->data_.first, k))
-  {
-    ++iter;
-  }
-  return iter;
+  return ConstIterator(getFirstNotLess(k), this);
 }
 
 template< typename K, typename V, typename C >
 typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::lowerBound(const K& k) const
 {
-  ConstIterator iter = begin();
-  while (iter != end() && !isLess(k, iter.leaf_->data_.first))
-  {
-    ++iter;
-  }
-  return iter;
+  return ConstIterator(getFirstGreater(k), this);
 }
 
 template< typename K, typename V, typename C >
@@ -979,32 +1000,10 @@ void ivlicheva::BinarySearchTree< K, V, C >::insert(std::initializer_list< std::
 template< typename K, typename V, typename C >
 void ivlicheva::BinarySearchTree< K, V, C >::drop(const K& k)
 {
-  if (isEqual(k, root_->data_.first))
-  {
-    drop(root_);
-    return;
-  }
-  tree_t* tmp = root_;
-  while (tmp)
+  tree_t* leaf = getEqual(k);
+  if (!isNil(leaf))
   {
-    if (isLess(k, tmp->data_.first))
-    {
-      tmp = tmp->left_;
-      if (tmp->data_.first == k)
-      {
-        drop(tmp);
-        break;
-      }
-    }
-    if (!isLess(k, tmp->data_.first))
-    {
-      tmp = tmp->right_;
-      if (tmp->data_.first == k)
-      {
-        drop(tmp);
-        break;
-      }
-    }
+    drop(leaf);
   }
 }
 
@@ -1241,12 +1240,195 @@ bool ivlicheva::BinarySearchTree< K, V, C >::isBlack(const tree_t* leaf) const
   return leaf->color_ == 'b';
 }
 
+template< typename K, typename V, typename C >
+ivlicheva::TreeShape ivlicheva::BinarySearchTree< K, V, C >::shapeStats() const
+{
+  TreeShape result{0, 0, 0, 0, 0.0, leftTurns_, rightTurns_};
+  size_t totalDepth = 0;
+  size_t depth = 0;
+  tree_t* leaf = root_;
+  tree_t* from = nullptr;
+  while (leaf)
+  {
+    tree_t* next = leaf->parent_;
+    if (from == leaf->parent_)
+    {
+      ++result.size_;
+      totalDepth += depth;
+      result.maxDepth_ = std::max(result.maxDepth_, depth);
+      if (!isNil(leaf->left_))
+      {
+        next = leaf->left_;
+      }
+      else if (!isNil(leaf->right_))
+      {
+        next = leaf->right_;
+      }
+    }
+    else if (from == leaf->left_ && !isNil(leaf->right_))
+    {
+      next = leaf->right_;
+    }
+    from = leaf;
+    depth = next == leaf->parent_ ? depth - 1 : depth + 1;
+    leaf = next;
+  }
+  if (result.size_)
+  {
+    result.height_ = result.maxDepth_ + 1;
+    result.blackHeight_ = getBlackHigh(root_);
+    result.averageDepth_ = static_cast< double >(totalDepth) / static_cast< double >(result.size_);
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BinarySearchTree< K, V, C >::validate() const
+{
+  if (!root_)
+  {
+    return;
+  }
+  if (root_->parent_)
+  {
+    throw std::logic_error("Bad root");
+  }
+  size_t blackHeight = 0;
+  size_t black = 0;
+  tree_t* leaf = root_;
+  tree_t* from = nullptr;
+  tree_t* prev = nullptr;
+  while (leaf)
+  {
+    tree_t* next = leaf->parent_;
+    if ((from == leaf->parent_ && isNil(leaf->left_)) || from == leaf->left_)
+    {
+      if (prev && isLess(leaf->data_.first, prev->data_.first))
+      {
+        throw std::logic_error("Bad order");
+      }
+      prev = leaf;
+    }
+    if (from == leaf->parent_)
+    {
+      if (!isRed(leaf) && !isBlack(leaf))
+      {
+        throw std::logic_error("Bad color");
+      }
+      black += isBlack(leaf) ? 1 : 0;
+      for (tree_t* child: {leaf->left_, leaf->right_})
+      {
+        if (isNil(child))
+        {
+          blackHeight = blackHeight ? blackHeight : black;
+          if (black != blackHeight)
+          {
+            throw std::logic_error("Bad black height");
+          }
+        }
+        else if (child->parent_ != leaf)
+        {
+          throw std::logic_error("Bad parent");
+        }
+        else if (isRed(leaf) && isRed(child))
+        {
+          throw std::logic_error("Bad color");
+        }
+      }
+      if (!isNil(leaf->left_))
+      {
+        next = leaf->left_;
+      }
+      else if (!isNil(leaf->right_))
+      {
+        next = leaf->right_;
+      }
+    }
+    else if (from == leaf->left_ && !isNil(leaf->right_))
+    {
+      next = leaf->right_;
+    }
+    if (next == leaf->parent_)
+    {
+      black -= isBlack(leaf) ? 1 : 0;
+    }
+    from = leaf;
+    leaf = next;
+  }
+}
+
 template < typename K, typename V, typename C >
 bool ivlicheva::BinarySearchTree< K, V, C >::isEmpty() const noexcept
 {
   return !root_;
 }
 
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::BinarySearchTree< K, V, C >::forEachValue(F f)
+{
+  if (root_)
+  {
+    auto g = [&f](tree_t* leaf)
+     {
+       f(leaf->data_.second);
+     };
+    visit(root_, g);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::BinarySearchTree< K, V, C >::forEachValue(F f) const
+{
+  if (root_)
+  {
+    auto g = [&f](const tree_t* leaf)
+     {
+       f(leaf->data_.second);
+     };
+    visit(root_, g);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+void ivlicheva::BinarySearchTree< K, V, C >::parallelForEachValue(F f, size_t threads)
+{
+  if (!root_)
+  {
+    return;
+  }
+  threads = threads ? threads : std::thread::hardware_concurrency();
+  size_t depth = 0;
+  while (threads > 1 && (static_cast< size_t >(1) << depth) < threads * 4)
+  {
+    ++depth;
+  }
+  std::vector< tree_t* > roots;
+  std::vector< tree_t* > upper;
+  collectRoots(root_, depth, roots, upper);
+  runTasks(roots.size() + 1, threads, [&](size_t i)
+   {
+     F local(f);
+     auto g = [&local](tree_t* leaf)
+      {
+        local(leaf->data_.second);
+      };
+     if (i < roots.size())
+     {
+       visit(roots[i], g);
+       return;
+     }
+     for (tree_t* leaf: upper)
+     {
+       g(leaf);
+     }
+   });
+}
+
 template< typename K, typename V, typename C >
 template< typename F >
 F ivlicheva::BinarySearchTree< K, V, C >::traverseLNR(F f) const
@@ -1393,16 +1575,208 @@ void ivlicheva::BinarySearchTree< K, V, C >::colorize(tree_t* leaf, char c)
   leaf->color_ = c;
 }
 
+template< typename K, typename V, typename C >
+typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getFirstNotLess(const K& k) const
+{
+  tree_t* result = nil_;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
+  {
+    if (isLess(tmp->data_.first, k))
+    {
+      tmp = tmp->right_;
+    }
+    else
+    {
+      result = tmp;
+      tmp = tmp->left_;
+    }
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getFirstGreater(const K& k) const
+{
+  tree_t* result = nil_;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
+  {
+    if (isLess(k, tmp->data_.first))
+    {
+      result = tmp;
+      tmp = tmp->left_;
+    }
+    else
+    {
+      tmp = tmp->right_;
+    }
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getEqual(const K& k) const
+{
+  return getEqual(k, detail::HasThreeWay< C >());
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getEqual(const K& k, std::true_type) const
+{
+  tree_t* result = nil_;
+  bool isFound = false;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
+  {
+    int order = compare(tmp->data_.first, k);
+    if (order < 0)
+    {
+      tmp = tmp->right_;
+    }
+    else
+    {
+      result = tmp;
+      isFound = !order;
+      tmp = tmp->left_;
+    }
+  }
+  return isFound ? result : nil_;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getEqual(const K& k, std::false_type) const
+{
+  tree_t* result = getFirstNotLess(k);
+  if (!isNil(result) && isLess(k, result->data_.first))
+  {
+    return nil_;
+  }
+  return result;
+}
+
 template< typename K, typename V, typename C >
 bool ivlicheva::BinarySearchTree< K, V, C >::isLess(const K& k1, const K& k2) const
 {
   return cmp_(k1, k2);
 }
 
+template< typename K, typename V, typename C >
+int ivlicheva::BinarySearchTree< K, V, C >::compare(const K& k1, const K& k2) const
+{
+  return compare(k1, k2, detail::HasThreeWay< C >());
+}
+
+template< typename K, typename V, typename C >
+int ivlicheva::BinarySearchTree< K, V, C >::compare(const K& k1, const K& k2, std::true_type) const
+{
+  return cmp_.compare(k1, k2);
+}
+
+template< typename K, typename V, typename C >
+int ivlicheva::BinarySearchTree< K, V, C >::compare(const K& k1, const K& k2, std::false_type) const
+{
+  return isLess(k1, k2) ? -1 : static_cast< int >(isLess(k2, k1));
+}
+
 template< typename K, typename V, typename C >
 bool ivlicheva::BinarySearchTree< K, V, C >::isEqual(const K& k1, const K& k2) const
 {
-  return !isLess(k1, k2) && !isLess(k2, k1);
+  return !compare(k1, k2);
+}
+
+template< typename K, typename V, typename C >
+template< typename G >
+void ivlicheva::BinarySearchTree< K, V, C >::visit(tree_t* top, G& g) const
+{
+  tree_t* leaf = top;
+  tree_t* from = top->parent_;
+  while (leaf != top->parent_)
+  {
+    tree_t* next = leaf->parent_;
+    if (from == leaf->parent_ && !isNil(leaf->left_))
+    {
+      next = leaf->left_;
+    }
+    else if (from != leaf->right_)
+    {
+      g(leaf);
+      if (!isNil(leaf->right_))
+      {
+        next = leaf->right_;
+      }
+    }
+    from = leaf;
+    leaf = next;
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BinarySearchTree< K, V, C >::collectRoots(tree_t* leaf, size_t depth, std::vector< tree_t* >& roots, std::vector< tree_t* >& upper) const
+{
+  if (isNil(leaf))
+  {
+    return;
+  }
+  if (!depth)
+  {
+    roots.push_back(leaf);
+    return;
+  }
+  upper.push_back(leaf);
+  collectRoots(leaf->left_, depth - 1, roots, upper);
+  collectRoots(leaf->right_, depth - 1, roots, upper);
+}
+
+template< typename K, typename V, typename C >
+template< typename G >
+void ivlicheva::BinarySearchTree< K, V, C >::runTasks(size_t tasks, size_t threads, G task) const
+{
+  std::atomic< size_t > next(0);
+  std::vector< std::exception_ptr > errors(tasks);
+  auto worker = [&]()
+   {
+     for (size_t i = next++; i < tasks; i = next++)
+     {
+       try
+       {
+         task(i);
+       }
+       catch (...)
+       {
+         errors[i] = std::current_exception();
+       }
+     }
+   };
+  std::vector< std::thread > pool;
+  try
+  {
+    for (size_t i = 1; i < threads && i < tasks; ++i)
+    {
+      pool.emplace_back(worker);
+    }
+  }
+  catch (...)
+  {
+    next = tasks;
+    for (auto&& thread: pool)
+    {
+      thread.join();
+    }
+    throw;
+  }
+  worker();
+  for (auto&& thread: pool)
+  {
+    thread.join();
+  }
+  for (auto&& error: errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
 }
 
 #endif
@@ -0,0 +1,892 @@
+#ifndef HASHDICTIONARY_H
+#define HASHDICTIONARY_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <experimental/string_view>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ivlicheva
+{
+  namespace detail
+  {
+    constexpr int8_t ctrlEmpty = -128;
+    constexpr int8_t ctrlDeleted = -2;
+
+    class Group
+    {
+      public:
+        static constexpr size_t width = 16;
+
+        explicit Group(const int8_t* ctrl) noexcept;
+        uint32_t match(int8_t h2) const noexcept;
+        uint32_t matchEmpty() const noexcept;
+        uint32_t matchFree() const noexcept;
+
+      private:
+#if defined(__SSE2__)
+        __m128i ctrl_;
+#else
+        const int8_t* ctrl_;
+#endif
+    };
+
+    size_t hashBytes(const char* data, size_t size) noexcept;
+  }
+
+  struct StringHash
+  {
+    using is_transparent = void;
+    size_t operator()(const std::string& str) const noexcept
+    {
+      return detail::hashBytes(str.data(), str.size());
+    }
+    size_t operator()(const char* str) const noexcept
+    {
+      return detail::hashBytes(str, std::strlen(str));
+    }
+    size_t operator()(std::experimental::string_view str) const noexcept
+    {
+      return detail::hashBytes(str.data(), str.size());
+    }
+  };
+
+  struct StringEqual
+  {
+    using is_transparent = void;
+    bool operator()(const std::string& lhs, const std::string& rhs) const noexcept
+    {
+      return lhs == rhs;
+    }
+    bool operator()(const std::string& lhs, const char* rhs) const noexcept
+    {
+      return lhs == rhs;
+    }
+    bool operator()(const char* lhs, const std::string& rhs) const noexcept
+    {
+      return rhs == lhs;
+    }
+    bool operator()(const std::string& lhs, std::experimental::string_view rhs) const noexcept
+    {
+      return std::experimental::string_view(lhs) == rhs;
+    }
+    bool operator()(std::experimental::string_view lhs, const std::string& rhs) const noexcept
+    {
+      return lhs == std::experimental::string_view(rhs);
+    }
+  };
+
+  struct StringCompare
+  {
+    using is_transparent = void;
+    using three_way = void;
+    bool operator()(std::experimental::string_view lhs, std::experimental::string_view rhs) const noexcept
+    {
+      return lhs.compare(rhs) < 0;
+    }
+    int compare(std::experimental::string_view lhs, std::experimental::string_view rhs) const noexcept
+    {
+      return lhs.compare(rhs);
+    }
+  };
+
+  template< typename Key, typename Value, typename Hash = std::hash< Key >, typename Eq = std::equal_to< Key > >
+  class HashDictionary
+  {
+    public:
+      class ConstIterator;
+      class Iterator;
+      using data_t = std::pair< Key, Value >;
+      using this_t = HashDictionary< Key, Value, Hash, Eq >;
+      using iterator_t = Iterator;
+      using citerator_t = ConstIterator;
+
+      HashDictionary();
+      HashDictionary(const this_t&);
+      HashDictionary(this_t&&) noexcept;
+      HashDictionary(std::initializer_list< std::pair< Key, Value > >);
+      ~HashDictionary();
+
+      this_t& operator=(const this_t&);
+      this_t& operator=(this_t&&) noexcept;
+
+      void swap(this_t&) noexcept;
+      void push(const Key&, const Value&);
+      void push(Key&&, Value&&);
+      Iterator insert(const std::pair< Key, Value >&);
+      Iterator insert(std::pair< Key, Value >&&);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(const Key&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(Key&&, Args&&...);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(const Key&, M&&);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(Key&&, M&&);
+      Value& get(const Key&);
+      const Value& get(const Key&) const;
+      template< typename K, typename H = Hash, typename = typename H::is_transparent >
+      Value& get(const K&);
+      template< typename K, typename H = Hash, typename = typename H::is_transparent >
+      const Value& get(const K&) const;
+      Iterator find(const Key&);
+      ConstIterator find(const Key&) const;
+      template< typename K, typename H = Hash, typename = typename H::is_transparent >
+      Iterator find(const K&);
+      template< typename K, typename H = Hash, typename = typename H::is_transparent >
+      ConstIterator find(const K&) const;
+      size_t count(const Key&) const;
+      void drop(const Key&);
+      Iterator erase(Iterator);
+      void reserve(size_t);
+      bool isEmpty() const noexcept;
+      size_t size() const noexcept;
+
+      Iterator begin();
+      Iterator end();
+      ConstIterator begin() const;
+      ConstIterator end() const;
+      ConstIterator cbegin() const;
+      ConstIterator cend() const;
+
+    private:
+      using slot_t = typename std::aligned_storage< sizeof(data_t), alignof(data_t) >::type;
+
+      int8_t* ctrl_;
+      slot_t* slots_;
+      size_t capacity_;
+      size_t size_;
+      size_t deleted_;
+      Hash hash_;
+      Eq eq_;
+
+      void destroy() noexcept;
+      void rehash(size_t);
+      data_t* getSlot(size_t) const noexcept;
+      template< typename K >
+      size_t findIndex(const K&) const;
+      size_t findFree(uint64_t) const noexcept;
+      template< typename K, typename... Args >
+      std::pair< Iterator, bool > emplaceUnique(K&&, Args&&...);
+      void setCtrl(size_t, int8_t) noexcept;
+      size_t getNext(size_t) const noexcept;
+      static uint64_t mix(size_t) noexcept;
+  };
+}
+
+inline ivlicheva::detail::Group::Group(const int8_t* ctrl) noexcept:
+#if defined(__SSE2__)
+  ctrl_(_mm_loadu_si128(reinterpret_cast< const __m128i* >(ctrl)))
+#else
+  ctrl_(ctrl)
+#endif
+{}
+
+inline uint32_t ivlicheva::detail::Group::match(int8_t h2) const noexcept
+{
+#if defined(__SSE2__)
+  return static_cast< uint32_t >(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < width; ++i)
+  {
+    mask |= static_cast< uint32_t >(ctrl_[i] == h2) << i;
+  }
+  return mask;
+#endif
+}
+
+inline uint32_t ivlicheva::detail::Group::matchEmpty() const noexcept
+{
+  return match(ctrlEmpty);
+}
+
+inline uint32_t ivlicheva::detail::Group::matchFree() const noexcept
+{
+#if defined(__SSE2__)
+  return static_cast< uint32_t >(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl_)));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < width; ++i)
+  {
+    mask |= static_cast< uint32_t >(ctrl_[i] < -1) << i;
+  }
+  return mask;
+#endif
+}
+
+inline size_t ivlicheva::detail::hashBytes(const char* data, size_t size) noexcept
+{
+  uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+  while (size >= 8)
+  {
+    uint64_t word = 0;
+    std::memcpy(std::addressof(word), data, 8);
+    hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 32;
+    data += 8;
+    size -= 8;
+  }
+  uint64_t word = 0;
+  std::memcpy(std::addressof(word), data, size);
+  hash = (hash ^ word) * 0xC4CEB9FE1A85EC53ull;
+  return static_cast< size_t >(hash ^ (hash >> 29));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+class ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator: public std::iterator< std::forward_iterator_tag, std::pair< Key, Value > >
+{
+  public:
+    friend class HashDictionary< Key, Value, Hash, Eq >;
+    using this_t = ConstIterator;
+
+    ConstIterator();
+    ConstIterator(const this_t&) = default;
+    ~ConstIterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    const HashDictionary< Key, Value, Hash, Eq >* dict_;
+    size_t index_;
+    ConstIterator(const HashDictionary< Key, Value, Hash, Eq >*, size_t);
+};
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::ConstIterator():
+  dict_(nullptr),
+  index_(0)
+{}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::ConstIterator(const HashDictionary< Key, Value, Hash, Eq >* dict, size_t index):
+  dict_(dict),
+  index_(index)
+{}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::operator++()
+{
+  if (!dict_ || index_ == dict_->capacity_)
+  {
+    throw std::logic_error("Bad slot");
+  }
+  index_ = dict_->getNext(index_ + 1);
+  return *this;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+const typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::operator*() const
+{
+  return *dict_->getSlot(index_);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+const typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t* ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::operator->() const
+{
+  return dict_->getSlot(index_);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+bool ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::operator==(const this_t& iter) const
+{
+  return dict_ == iter.dict_ && index_ == iter.index_;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+bool ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+class ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator: public std::iterator< std::forward_iterator_tag, std::pair< Key, Value > >
+{
+  public:
+    friend class HashDictionary< Key, Value, Hash, Eq >;
+    using this_t = Iterator;
+
+    Iterator();
+    Iterator(const this_t&) = default;
+    Iterator(ConstIterator);
+    ~Iterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+
+    data_t& operator*();
+    data_t* operator->();
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    ConstIterator citer_;
+};
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::Iterator():
+  citer_()
+{}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::Iterator(ConstIterator citer):
+  citer_(citer)
+{}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator++()
+{
+  ++citer_;
+  return *this;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator*()
+{
+  return const_cast< data_t& >(*citer_);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t* ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator->()
+{
+  return std::addressof(const_cast< data_t& >(*citer_));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+const typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator*() const
+{
+  return *citer_;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+const typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t* ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator->() const
+{
+  return std::addressof(*citer_);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+bool ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator==(const this_t& iter) const
+{
+  return citer_ == iter.citer_;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+bool ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::HashDictionary():
+  ctrl_(nullptr),
+  slots_(nullptr),
+  capacity_(0),
+  size_(0),
+  deleted_(0),
+  hash_(),
+  eq_()
+{}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::HashDictionary(const this_t& ob):
+  HashDictionary()
+{
+  reserve(ob.size_);
+  for (auto&& item: ob)
+  {
+    push(item.first, item.second);
+  }
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::HashDictionary(this_t&& ob) noexcept:
+  ctrl_(ob.ctrl_),
+  slots_(ob.slots_),
+  capacity_(ob.capacity_),
+  size_(ob.size_),
+  deleted_(ob.deleted_),
+  hash_(std::move(ob.hash_)),
+  eq_(std::move(ob.eq_))
+{
+  ob.ctrl_ = nullptr;
+  ob.slots_ = nullptr;
+  ob.capacity_ = 0;
+  ob.size_ = 0;
+  ob.deleted_ = 0;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::HashDictionary(std::initializer_list< std::pair< Key, Value > > il):
+  HashDictionary()
+{
+  reserve(il.size());
+  for (auto&& item: il)
+  {
+    push(item.first, item.second);
+  }
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >::~HashDictionary()
+{
+  destroy();
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::operator=(const this_t& ob)
+{
+  if (this != std::addressof(ob))
+  {
+    this_t temp(ob);
+    swap(temp);
+  }
+  return *this;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+ivlicheva::HashDictionary< Key, Value, Hash, Eq >& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::operator=(this_t&& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    this_t tmp(std::move(ob));
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::swap(this_t& ob) noexcept
+{
+  std::swap(ctrl_, ob.ctrl_);
+  std::swap(slots_, ob.slots_);
+  std::swap(capacity_, ob.capacity_);
+  std::swap(size_, ob.size_);
+  std::swap(deleted_, ob.deleted_);
+  std::swap(hash_, ob.hash_);
+  std::swap(eq_, ob.eq_);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::push(const Key& k, const Value& v)
+{
+  emplaceUnique(k, v);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::push(Key&& k, Value&& v)
+{
+  emplaceUnique(std::move(k), std::move(v));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::insert(const std::pair< Key, Value >& p)
+{
+  return emplaceUnique(p.first, p.second).first;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::insert(std::pair< Key, Value >&& p)
+{
+  return emplaceUnique(std::move(p.first), std::move(p.second)).first;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename... Args >
+std::pair< typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator, bool > ivlicheva::HashDictionary< Key, Value, Hash, Eq >::tryEmplace(const Key& k, Args&&... args)
+{
+  return emplaceUnique(k, std::forward< Args >(args)...);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename... Args >
+std::pair< typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator, bool > ivlicheva::HashDictionary< Key, Value, Hash, Eq >::tryEmplace(Key&& k, Args&&... args)
+{
+  return emplaceUnique(std::move(k), std::forward< Args >(args)...);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename M >
+std::pair< typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator, bool > ivlicheva::HashDictionary< Key, Value, Hash, Eq >::insertOrAssign(const Key& k, M&& obj)
+{
+  size_t index = findIndex(k);
+  if (index != capacity_)
+  {
+    getSlot(index)->second = std::forward< M >(obj);
+    return {ConstIterator(this, index), false};
+  }
+  return emplaceUnique(k, std::forward< M >(obj));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename M >
+std::pair< typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator, bool > ivlicheva::HashDictionary< Key, Value, Hash, Eq >::insertOrAssign(Key&& k, M&& obj)
+{
+  size_t index = findIndex(k);
+  if (index != capacity_)
+  {
+    getSlot(index)->second = std::forward< M >(obj);
+    return {ConstIterator(this, index), false};
+  }
+  return emplaceUnique(std::move(k), std::forward< M >(obj));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+Value& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::get(const Key& k)
+{
+  return const_cast< Value& >(static_cast< const this_t& >(*this).get(k));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+const Value& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::get(const Key& k) const
+{
+  size_t index = findIndex(k);
+  if (index == capacity_)
+  {
+    throw std::logic_error("Error in get");
+  }
+  return getSlot(index)->second;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename K, typename H, typename >
+Value& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::get(const K& k)
+{
+  return const_cast< Value& >(static_cast< const this_t& >(*this).get(k));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename K, typename H, typename >
+const Value& ivlicheva::HashDictionary< Key, Value, Hash, Eq >::get(const K& k) const
+{
+  size_t index = findIndex(k);
+  if (index == capacity_)
+  {
+    throw std::logic_error("Error in get");
+  }
+  return getSlot(index)->second;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::find(const Key& k)
+{
+  return static_cast< const this_t& >(*this).find(k);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::find(const Key& k) const
+{
+  return ConstIterator(this, findIndex(k));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename K, typename H, typename >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::find(const K& k)
+{
+  return static_cast< const this_t& >(*this).find(k);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename K, typename H, typename >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::find(const K& k) const
+{
+  return ConstIterator(this, findIndex(k));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+size_t ivlicheva::HashDictionary< Key, Value, Hash, Eq >::count(const Key& k) const
+{
+  return findIndex(k) != capacity_;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::drop(const Key& k)
+{
+  size_t index = findIndex(k);
+  if (index != capacity_)
+  {
+    erase(ConstIterator(this, index));
+  }
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::erase(Iterator iter)
+{
+  size_t index = iter.citer_.index_;
+  if (index >= capacity_)
+  {
+    return end();
+  }
+  getSlot(index)->~data_t();
+  --size_;
+  size_t group = index & ~(detail::Group::width - 1);
+  if (detail::Group(ctrl_ + group).matchEmpty())
+  {
+    setCtrl(index, detail::ctrlEmpty);
+  }
+  else
+  {
+    setCtrl(index, detail::ctrlDeleted);
+    ++deleted_;
+  }
+  return ConstIterator(this, getNext(index + 1));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::reserve(size_t count)
+{
+  size_t capacity = capacity_ ? capacity_ : detail::Group::width;
+  while (count * 8 > capacity * 7)
+  {
+    capacity *= 2;
+  }
+  if (capacity != capacity_)
+  {
+    rehash(capacity);
+  }
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+bool ivlicheva::HashDictionary< Key, Value, Hash, Eq >::isEmpty() const noexcept
+{
+  return size_ == 0;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+size_t ivlicheva::HashDictionary< Key, Value, Hash, Eq >::size() const noexcept
+{
+  return size_;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::begin()
+{
+  return cbegin();
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::end()
+{
+  return cend();
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::begin() const
+{
+  return cbegin();
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::end() const
+{
+  return cend();
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::cbegin() const
+{
+  return ConstIterator(this, getNext(0));
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::ConstIterator ivlicheva::HashDictionary< Key, Value, Hash, Eq >::cend() const
+{
+  return ConstIterator(this, capacity_);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::destroy() noexcept
+{
+  for (size_t i = 0; i < capacity_; ++i)
+  {
+    if (ctrl_[i] >= 0)
+    {
+      getSlot(i)->~data_t();
+    }
+  }
+  delete[] ctrl_;
+  delete[] slots_;
+  ctrl_ = nullptr;
+  slots_ = nullptr;
+  capacity_ = 0;
+  size_ = 0;
+  deleted_ = 0;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::rehash(size_t capacity)
+{
+  this_t temp;
+  temp.ctrl_ = new int8_t[capacity];
+  try
+  {
+    temp.slots_ = new slot_t[capacity];
+  }
+  catch (...)
+  {
+    delete[] temp.ctrl_;
+    temp.ctrl_ = nullptr;
+    throw;
+  }
+  std::memset(temp.ctrl_, detail::ctrlEmpty, capacity);
+  temp.capacity_ = capacity;
+  temp.hash_ = hash_;
+  temp.eq_ = eq_;
+  for (size_t i = 0; i < capacity_; ++i)
+  {
+    if (ctrl_[i] >= 0)
+    {
+      uint64_t hash = mix(hash_(getSlot(i)->first));
+      size_t index = temp.findFree(hash);
+      new (temp.getSlot(index)) data_t(std::move_if_noexcept(*getSlot(i)));
+      temp.setCtrl(index, static_cast< int8_t >(hash & 0x7F));
+      ++temp.size_;
+    }
+  }
+  swap(temp);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::data_t* ivlicheva::HashDictionary< Key, Value, Hash, Eq >::getSlot(size_t index) const noexcept
+{
+  return reinterpret_cast< data_t* >(slots_ + index);
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename K >
+size_t ivlicheva::HashDictionary< Key, Value, Hash, Eq >::findIndex(const K& k) const
+{
+  if (!size_)
+  {
+    return capacity_;
+  }
+  uint64_t hash = mix(hash_(k));
+  int8_t h2 = static_cast< int8_t >(hash & 0x7F);
+  size_t groups = capacity_ / detail::Group::width;
+  size_t group = (hash >> 7) & (groups - 1);
+  for (size_t step = 1; step <= groups; ++step)
+  {
+    const int8_t* ctrl = ctrl_ + group * detail::Group::width;
+    detail::Group slots(ctrl);
+    for (uint32_t mask = slots.match(h2); mask; mask &= mask - 1)
+    {
+      size_t index = group * detail::Group::width + __builtin_ctz(mask);
+      if (eq_(getSlot(index)->first, k))
+      {
+        return index;
+      }
+    }
+    if (slots.matchEmpty())
+    {
+      break;
+    }
+    group = (group + step) & (groups - 1);
+  }
+  return capacity_;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+template< typename K, typename... Args >
+std::pair< typename ivlicheva::HashDictionary< Key, Value, Hash, Eq >::Iterator, bool > ivlicheva::HashDictionary< Key, Value, Hash, Eq >::emplaceUnique(K&& k, Args&&... args)
+{
+  size_t index = findIndex(k);
+  if (index != capacity_)
+  {
+    return {ConstIterator(this, index), false};
+  }
+  if ((size_ + deleted_ + 1) * 8 > capacity_ * 7)
+  {
+    size_t capacity = capacity_ ? capacity_ : detail::Group::width;
+    rehash((size_ + 1) * 16 > capacity * 7 ? capacity * 2 : capacity);
+  }
+  uint64_t hash = mix(hash_(k));
+  index = findFree(hash);
+  new (getSlot(index)) data_t(std::piecewise_construct, std::forward_as_tuple(std::forward< K >(k)), std::forward_as_tuple(std::forward< Args >(args)...));
+  if (ctrl_[index] == detail::ctrlDeleted)
+  {
+    --deleted_;
+  }
+  setCtrl(index, static_cast< int8_t >(hash & 0x7F));
+  ++size_;
+  return {ConstIterator(this, index), true};
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+size_t ivlicheva::HashDictionary< Key, Value, Hash, Eq >::findFree(uint64_t hash) const noexcept
+{
+  size_t groups = capacity_ / detail::Group::width;
+  size_t group = (hash >> 7) & (groups - 1);
+  for (size_t step = 1; ; ++step)
+  {
+    uint32_t mask = detail::Group(ctrl_ + group * detail::Group::width).matchFree();
+    if (mask)
+    {
+      return group * detail::Group::width + __builtin_ctz(mask);
+    }
+    group = (group + step) & (groups - 1);
+  }
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+void ivlicheva::HashDictionary< Key, Value, Hash, Eq >::setCtrl(size_t index, int8_t ctrl) noexcept
+{
+  ctrl_[index] = ctrl;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+size_t ivlicheva::HashDictionary< Key, Value, Hash, Eq >::getNext(size_t index) const noexcept
+{
+  while (index < capacity_ && ctrl_[index] < 0)
+  {
+    ++index;
+  }
+  return index;
+}
+
+template< typename Key, typename Value, typename Hash, typename Eq >
+uint64_t ivlicheva::HashDictionary< Key, Value, Hash, Eq >::mix(size_t hash) noexcept
+{
+  uint64_t mixed = static_cast< uint64_t >(hash) * 0x9E3779B97F4A7C15ull;
+  return mixed ^ (mixed >> 32);
+}
+
+#endif
@@ -34,8 +34,8 @@ namespace
   }
 }
 
-ivlicheva::Commands::Commands(const tree_t& matrixTree, std::istream& in, std::ostream& out):
-  matrixTree_(matrixTree),
+ivlicheva::Commands::Commands(const matrices_t& matrices, std::istream& in, std::ostream& out):
+  matrices_(matrices),
   in_(in),
   out_(out)
 {}
@@ -67,8 +67,8 @@ bool ivlicheva::Commands::fill()
 {
   std::string matrixName = "";
   in_ >> matrixName;
-  auto iter = matrixTree_.find(matrixName);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixName);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -94,8 +94,8 @@ bool ivlicheva::Commands::mult()
 {
   std::string newMatrixName = "", matrixName = "", parameter = "";
   in_ >> newMatrixName >> matrixName >> parameter;
-  auto iter = matrixTree_.find(matrixName);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixName);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -104,9 +104,9 @@ bool ivlicheva::Commands::mult()
   {
     insert(newMatrixName, matrix * std::stoi(parameter));
   }
-  else if (matrixTree_.find(parameter) != matrixTree_.end())
+  else if (matrices_.find(parameter) != matrices_.end())
   {
-    insert(newMatrixName, matrix * matrixTree_.find(parameter)->second);
+    insert(newMatrixName, matrix * matrices_.find(parameter)->second);
   }
   else
   {
@@ -119,9 +119,9 @@ bool ivlicheva::Commands::sum()
 {
   std::string newMatrixName = "", matrixName1 = "", matrixName2 = "";
   in_ >> newMatrixName >> matrixName1 >> matrixName2;
-  auto iter1 = matrixTree_.find(matrixName1);
-  auto iter2 = matrixTree_.find(matrixName2);
-  if (iter1 == matrixTree_.end() || iter2 == matrixTree_.end())
+  auto iter1 = matrices_.find(matrixName1);
+  auto iter2 = matrices_.find(matrixName2);
+  if (iter1 == matrices_.end() || iter2 == matrices_.end())
   {
     return false;
   }
@@ -133,9 +133,9 @@ bool ivlicheva::Commands::substract()
 {
   std::string newMatrixName = "", matrixName1 = "", matrixName2 = "";
   in_ >> newMatrixName >> matrixName1 >> matrixName2;
-  auto iter1 = matrixTree_.find(matrixName1);
-  auto iter2 = matrixTree_.find(matrixName2);
-  if (iter1 == matrixTree_.end() || iter2 == matrixTree_.end())
+  auto iter1 = matrices_.find(matrixName1);
+  auto iter2 = matrices_.find(matrixName2);
+  if (iter1 == matrices_.end() || iter2 == matrices_.end())
   {
     return false;
   }
@@ -147,8 +147,8 @@ bool ivlicheva::Commands::getDeterminant()
 {
   std::string matrixname = "";
   in_ >> matrixname;
-  auto iter = matrixTree_.find(matrixname);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixname);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -165,8 +165,8 @@ bool ivlicheva::Commands::hconcat()
   while (!str.empty())
   {
     std::string matrixName = getSubstring(str);
-    auto iter = matrixTree_.find(matrixName);
-    if (iter == matrixTree_.end())
+    auto iter = matrices_.find(matrixName);
+    if (iter == matrices_.end())
     {
       return false;
     }
@@ -190,8 +190,8 @@ bool ivlicheva::Commands::vconcat()
   while (!str.empty())
   {
     std::string matrixName = getSubstring(str);
-    auto iter = matrixTree_.find(matrixName);
-    if (iter == matrixTree_.end())
+    auto iter = matrices_.find(matrixName);
+    if (iter == matrices_.end())
     {
       return false;
     }
@@ -210,8 +210,8 @@ bool ivlicheva::Commands::hrepeat()
 {
   std::string newMatrixname = "", matrixName = "";
   in_ >> newMatrixname >> matrixName;
-  auto iter = matrixTree_.find(matrixName);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixName);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -234,8 +234,8 @@ bool ivlicheva::Commands::vrepeat()
 {
   std::string newMatrixname = "", matrixName = "";
   in_ >> newMatrixname >> matrixName;
-  auto iter = matrixTree_.find(matrixName);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixName);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -258,8 +258,8 @@ bool ivlicheva::Commands::repeat()
 {
   std::string newMatrixname = "", matrixName = "";
   in_ >> newMatrixname >> matrixName;
-  auto iter = matrixTree_.find(matrixName);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixName);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -287,8 +287,8 @@ bool ivlicheva::Commands::print()
 {
   std::string matrixName = "";
   in_ >> matrixName;
-  auto iter = matrixTree_.find(matrixName);
-  if (iter == matrixTree_.end())
+  auto iter = matrices_.find(matrixName);
+  if (iter == matrices_.end())
   {
     return false;
   }
@@ -296,6 +296,27 @@ bool ivlicheva::Commands::print()
   return true;
 }
 
+void ivlicheva::Commands::printTreeStats(std::ostream& out) const
+{
+  for (auto&& matrix: matrices_)
+  {
+    const Matrix< int >::tree_t& tree = matrix.second.getTree();
+    TreeShape shape = tree.shapeStats();
+    out << matrix.first << ": size " << shape.size_ << ", height " << shape.height_;
+    out << ", black height " << shape.blackHeight_ << ", depth avg " << shape.averageDepth_ << " max " << shape.maxDepth_;
+    out << ", turns left " << shape.leftTurns_ << " right " << shape.rightTurns_;
+    try
+    {
+      tree.validate();
+      out << ", valid\n";
+    }
+    catch (const std::exception& e)
+    {
+      out << ", invalid: " << e.what() << '\n';
+    }
+  }
+}
+
 void ivlicheva::Commands::fillRandom(Matrix< int >& matrix)
 {
   matrix.traverse(
@@ -365,12 +386,5 @@ ivlicheva::Matrix< int > ivlicheva::Commands::dovconcat(const Matrix< int >& mat
 
 void ivlicheva::Commands::insert(const std::string& name, const Matrix< int >& matrix)
 {
-  if (matrixTree_.count(name))
-  {
-    matrixTree_.find(name)->second = matrix;
-  }
-  else
-  {
-    matrixTree_.insert({name, matrix});
-  }
+  matrices_.insertOrAssign(name, matrix);
 }
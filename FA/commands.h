@@ -3,14 +3,15 @@
 
 #include <iosfwd>
 #include "matrix.h"
+#include "HashDictionary.h"
 
 namespace ivlicheva
 {
   struct Commands
   {
-    using tree_t = BinarySearchTree< std::string, Matrix< int >, std::less< std::string > >;
+    using matrices_t = HashDictionary< std::string, Matrix< int >, StringHash, StringEqual >;
     public:
-      Commands(const tree_t&, std::istream&, std::ostream&);
+      Commands(const matrices_t&, std::istream&, std::ostream&);
       bool create();
       bool input();
       bool fill();
@@ -24,9 +25,10 @@ namespace ivlicheva
       bool vrepeat();
       bool repeat();
       bool print();
+      void printTreeStats(std::ostream&) const;
 
     private:
-      tree_t matrixTree_;
+      matrices_t matrices_;
       std::istream& in_;
       std::ostream& out_;
       void fillRandom(Matrix< int >&);
@@ -2,13 +2,15 @@
 #include <fstream>
 #include <limits>
 #include <string>
+#include <utility>
 #include <functional>
 #include "commands.h"
 #include "matrix.h"
+#include "HashDictionary.h"
 
 int main(int argc, char** argv)
 {
-  if (argc != 2)
+  if (argc != 2 && !(argc == 3 && std::string(argv[2]) == "--tree-stats"))
   {
     std::cerr << "Bad args\n";
     return 1;
@@ -19,14 +21,14 @@ int main(int argc, char** argv)
     std::cerr << "File is not open\n";
     return 1;
   }
-  ivlicheva::Commands::tree_t matrices;
+  ivlicheva::Commands::matrices_t matrices;
   while (!file.eof())
   {
     std::string matrixName = "";
     file >> matrixName;
     if (!matrixName.empty())
     {
-      matrices.insert({matrixName, ivlicheva::Matrix< int >(file)});
+      matrices.insert({std::move(matrixName), ivlicheva::Matrix< int >(file)});
     }
     if (!file)
     {
@@ -37,7 +39,7 @@ int main(int argc, char** argv)
   file.close();
   ivlicheva::Commands commands(matrices, std::cin, std::cout);
   using command_t = std::function< bool(void) >;
-  ivlicheva::BinarySearchTree< std::string, command_t, std::less< std::string > > treeOfCommands(
+  ivlicheva::HashDictionary< std::string, command_t, ivlicheva::StringHash, ivlicheva::StringEqual > tableOfCommands(
    {
      {"create", std::bind(&ivlicheva::Commands::create, std::ref(commands))},
      {"input", std::bind(&ivlicheva::Commands::input, std::ref(commands))},
@@ -59,8 +61,8 @@ int main(int argc, char** argv)
     std::cin >> nameOfCommand;
     if (!nameOfCommand.empty())
     {
-      auto commandIter = treeOfCommands.find(nameOfCommand);
-      if (commandIter == treeOfCommands.end() || !commandIter->second())
+      auto commandIter = tableOfCommands.find(nameOfCommand);
+      if (commandIter == tableOfCommands.end() || !commandIter->second())
       {
         std::cout << "<INVALID COMMAND>\n";
         if (!std::cin)
@@ -71,5 +73,9 @@ int main(int argc, char** argv)
       }
     }
   }
+  if (argc == 3)
+  {
+    commands.printTreeStats(std::cerr);
+  }
   return 0;
 }
@@ -33,6 +33,7 @@ namespace ivlicheva
       const size_t& getRows() const noexcept;
       const size_t& getColumns() const noexcept;
       size_t getSize() const noexcept;
+      const tree_t& getTree() const noexcept;
       const T& getElement(const size_t&, const size_t&) const;
       T& getElement(const size_t&, const size_t&);
       T getDeterminant();
@@ -208,6 +209,12 @@ size_t ivlicheva::Matrix< T >::getSize() const noexcept
   return rows_ * columns_;
 }
 
+template< typename T >
+const typename ivlicheva::Matrix< T >::tree_t& ivlicheva::Matrix< T >::getTree() const noexcept
+{
+  return tree_;
+}
+
 template< typename T >
 const T& ivlicheva::Matrix< T >::getElement(const size_t& i, const size_t& j) const
 {
@@ -247,13 +254,14 @@ template< typename T >
 ivlicheva::Matrix< T > ivlicheva::Matrix< T >::getNewMatrix(size_t i0, size_t j0)
 {
   tree_t tree;
+  size_t index = 0;
   for (size_t i = 0; i < rows_; ++i)
   {
     for (size_t j = 0; j < columns_; ++j)
     {
       if (i != i0 && j != j0)
       {
-        tree.push(getIndex(i, j), getElement(i, j));
+        tree.push(index++, getElement(i, j));
       }
     }
   }
@@ -264,28 +272,14 @@ template< typename T >
 template< typename F >
 F ivlicheva::Matrix< T >::traverse(F f)
 {
-  for (size_t i = 0; i < rows_; ++i)
-  {
-    for (size_t j = 0; j < columns_; ++j)
-    {
-      f(getElement(i, j));
-    }
-  }
-  return f;
+  return tree_.forEachValue(f);
 }
 
 template< typename T >
 template< typename F >
 F ivlicheva::Matrix< T >::traverse(F f) const
 {
-  for (size_t i = 0; i < rows_; ++i)
-  {
-    for (size_t j = 0; j < columns_; ++j)
-    {
-      f(getElement(i, j));
-    }
-  }
-  return f;
+  return tree_.forEachValue(f);
 }
 
 template< typename T >
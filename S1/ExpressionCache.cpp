@@ -0,0 +1,68 @@
+#include "ExpressionCache.h"
+#include <algorithm>
+#include "Funcs.h"
+
+ivlicheva::ExpressionCache::ExpressionCache(size_t capacity, size_t minLength, bool isTrapAllowed, bool isDag):
+  results_(),
+  key_(),
+  capacity_(capacity),
+  minLength_(minLength),
+  isTrapAllowed_(isTrapAllowed),
+  isDag_(isDag),
+  hits_(0),
+  misses_(0)
+{}
+
+long long ivlicheva::ExpressionCache::evaluate(std::experimental::string_view line)
+{
+  if (line.size() < minLength_)
+  {
+    return evaluateLine(line);
+  }
+  key_.resize(line.size());
+  key_.resize(std::remove_copy(line.begin(), line.end(), &key_[0], ' ') - &key_[0]);
+  auto iter = results_.find(key_);
+  if (iter != results_.end())
+  {
+    ++hits_;
+    if (iter->second.error_)
+    {
+      std::rethrow_exception(iter->second.error_);
+    }
+    return iter->second.value_;
+  }
+  ++misses_;
+  Result result{0, nullptr};
+  try
+  {
+    result.value_ = evaluateLine(key_);
+  }
+  catch (const std::exception&)
+  {
+    result.error_ = std::current_exception();
+  }
+  if (results_.size() < capacity_)
+  {
+    results_.push(key_, result);
+  }
+  if (result.error_)
+  {
+    std::rethrow_exception(result.error_);
+  }
+  return result.value_;
+}
+
+long long ivlicheva::ExpressionCache::evaluateLine(std::experimental::string_view line) const
+{
+  return isDag_ ? evaluateExpressionDag(line, isTrapAllowed_) : evaluateExpression(line, isTrapAllowed_);
+}
+
+size_t ivlicheva::ExpressionCache::getHits() const noexcept
+{
+  return hits_;
+}
+
+size_t ivlicheva::ExpressionCache::getMisses() const noexcept
+{
+  return misses_;
+}
@@ -0,0 +1,42 @@
+#ifndef EXPRESSIONCACHE_H
+#define EXPRESSIONCACHE_H
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <experimental/string_view>
+#include "HashDictionary.h"
+
+namespace ivlicheva
+{
+  class ExpressionCache
+  {
+    public:
+      explicit ExpressionCache(size_t capacity = 65536, size_t minLength = 32, bool isTrapAllowed = true, bool isDag = false);
+      ~ExpressionCache() = default;
+
+      long long evaluate(std::experimental::string_view line);
+      size_t getHits() const noexcept;
+      size_t getMisses() const noexcept;
+
+    private:
+      struct Result
+      {
+        long long value_;
+        std::exception_ptr error_;
+      };
+
+      long long evaluateLine(std::experimental::string_view line) const;
+
+      HashDictionary< std::string, Result, StringHash, StringEqual > results_;
+      std::string key_;
+      size_t capacity_;
+      size_t minLength_;
+      bool isTrapAllowed_;
+      bool isDag_;
+      size_t hits_;
+      size_t misses_;
+  };
+}
+
+#endif
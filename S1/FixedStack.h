@@ -0,0 +1,85 @@
+#ifndef FIXEDSTACK_H
+#define FIXEDSTACK_H
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace ivlicheva
+{
+  template< typename T, size_t N >
+  class FixedStack
+  {
+    public:
+      FixedStack();
+      FixedStack(const FixedStack< T, N >&) = default;
+      ~FixedStack() = default;
+
+      FixedStack< T, N >& operator=(const FixedStack< T, N >&) = default;
+
+      void push(const T& value);
+      void drop();
+      void clear() noexcept;
+      const T& getTop() const;
+      bool isEmpty() const noexcept;
+      size_t size() const noexcept;
+
+    private:
+      T data_[N];
+      size_t size_;
+  };
+}
+
+template< typename T, size_t N >
+ivlicheva::FixedStack< T, N >::FixedStack():
+  size_(0)
+{}
+
+template< typename T, size_t N >
+void ivlicheva::FixedStack< T, N >::push(const T& value)
+{
+  if (size_ == N)
+  {
+    throw std::length_error("It is full");
+  }
+  data_[size_++] = value;
+}
+
+template< typename T, size_t N >
+void ivlicheva::FixedStack< T, N >::drop()
+{
+  if (!size_)
+  {
+    throw std::logic_error("It is empty");
+  }
+  --size_;
+}
+
+template< typename T, size_t N >
+void ivlicheva::FixedStack< T, N >::clear() noexcept
+{
+  size_ = 0;
+}
+
+template< typename T, size_t N >
+const T& ivlicheva::FixedStack< T, N >::getTop() const
+{
+  if (!size_)
+  {
+    throw std::logic_error("It is empty");
+  }
+  return data_[size_ - 1];
+}
+
+template< typename T, size_t N >
+bool ivlicheva::FixedStack< T, N >::isEmpty() const noexcept
+{
+  return !size_;
+}
+
+template< typename T, size_t N >
+size_t ivlicheva::FixedStack< T, N >::size() const noexcept
+{
+  return size_;
+}
+
+#endif
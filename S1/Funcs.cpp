@@ -1,9 +1,19 @@
 #include "Funcs.h"
 #include <iostream>
 #include <string>
+#include <cstdint>
 #include <limits>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
 #include "Queue.h"
 #include "Stack.h"
+#include "FixedStack.h"
+#include "SpillStack.h"
+#include "GrowingStack.h"
+#include "HashDictionary.h"
 #include "ExpressionPart.h"
 
 namespace
@@ -73,6 +83,388 @@ namespace
     bool isSecond = op2 == ivlicheva::ExpressionPart('+') || op2 == ivlicheva::ExpressionPart('-');
     return isFirst && isSecond;
   }
+
+  bool comparator(char op1, char op2)
+  {
+    return (op1 == '*' || op1 == '/' || op1 == '%') && (op2 == '+' || op2 == '-');
+  }
+
+  long long calculate(char operation, long long a, long long b)
+  {
+    if (operation == '-')
+    {
+      return sum(a, b * (-1));
+    }
+    else if (operation == '+')
+    {
+      return sum(a, b);
+    }
+    else if (operation == '*')
+    {
+      return mult(a, b);
+    }
+    else if (operation == '/')
+    {
+      if (b == 0)
+      {
+        throw std::logic_error("Error. Division by zero");
+      }
+      return a / b;
+    }
+    if (a < 0)
+    {
+      return a + b * (std::abs(a) / b + 1);
+    }
+    return a % b;
+  }
+
+  bool isTrapping(char operation, long long a, long long b)
+  {
+    bool isMinByMinusOne = a == std::numeric_limits< long long >::min() && b == -1;
+    return (operation == '%' && (b == 0 || isMinByMinusOne)) || (operation == '/' && isMinByMinusOne);
+  }
+
+  struct Operand
+  {
+    long long value_;
+    bool isBracket_;
+  };
+
+  constexpr size_t fixedCapacity = 256;
+
+  template< typename T >
+  using FixedStorage = ivlicheva::FixedStack< T, fixedCapacity >;
+
+  template< template< typename > class Storage >
+  class LineEvaluator
+  {
+    public:
+      LineEvaluator();
+
+      void pushOperand(long long);
+      void pushSymbol(char);
+      void openGroup(size_t span);
+      bool closeGroup(size_t& span, long long& value);
+      long long getResult(bool isTrapAllowed);
+
+    private:
+      struct Group
+      {
+        size_t span_;
+        size_t depth_;
+        size_t lowest_;
+      };
+
+      Storage< char > operations_;
+      Storage< Operand > operands_;
+      Storage< Group > groups_;
+      std::exception_ptr error_;
+      size_t lowest_;
+      char deferredOperation_;
+      long long deferredFirst_;
+      long long deferredSecond_;
+      bool isBroken_;
+
+      void emit(const Operand&);
+      void emit(char);
+      long long popOperand();
+  };
+
+  template< template< typename > class Storage >
+  LineEvaluator< Storage >::LineEvaluator():
+    operations_(),
+    operands_(),
+    groups_(),
+    error_(),
+    lowest_(0),
+    deferredOperation_('\0'),
+    deferredFirst_(0),
+    deferredSecond_(0),
+    isBroken_(false)
+  {}
+
+  template< template< typename > class Storage >
+  void LineEvaluator< Storage >::pushOperand(long long value)
+  {
+    if (!isBroken_)
+    {
+      emit(Operand{value, false});
+    }
+  }
+
+  template< template< typename > class Storage >
+  void LineEvaluator< Storage >::pushSymbol(char symbol)
+  {
+    if (isBroken_)
+    {
+      return;
+    }
+    if (symbol == '(')
+    {
+      operations_.push(symbol);
+    }
+    else if (symbol == ')')
+    {
+      while (!operations_.isEmpty() && operations_.getTop() != '(')
+      {
+        emit(operations_.getTop());
+        operations_.drop();
+      }
+      if (operations_.isEmpty())
+      {
+        isBroken_ = true;
+        return;
+      }
+      operations_.drop();
+    }
+    else
+    {
+      while (!operations_.isEmpty() && !comparator(symbol, operations_.getTop()) && operations_.getTop() != '(')
+      {
+        emit(operations_.getTop());
+        operations_.drop();
+      }
+      operations_.push(symbol);
+    }
+  }
+
+  template< template< typename > class Storage >
+  void LineEvaluator< Storage >::openGroup(size_t span)
+  {
+    groups_.push(Group{span, operands_.size(), lowest_});
+    lowest_ = operands_.size();
+  }
+
+  template< template< typename > class Storage >
+  bool LineEvaluator< Storage >::closeGroup(size_t& span, long long& value)
+  {
+    if (groups_.isEmpty())
+    {
+      return false;
+    }
+    Group group = groups_.getTop();
+    groups_.drop();
+    bool isPure = !isBroken_ && !error_ && !deferredOperation_ && lowest_ >= group.depth_;
+    isPure = isPure && operands_.size() == group.depth_ + 1 && !operands_.getTop().isBracket_;
+    lowest_ = std::min(lowest_, group.lowest_);
+    span = group.span_;
+    value = isPure ? operands_.getTop().value_ : 0;
+    return isPure;
+  }
+
+  template< template< typename > class Storage >
+  long long LineEvaluator< Storage >::getResult(bool isTrapAllowed)
+  {
+    if (isBroken_)
+    {
+      throw std::logic_error("It is empty");
+    }
+    if (!operations_.isEmpty())
+    {
+      emit(operations_.getTop());
+    }
+    if (error_)
+    {
+      std::rethrow_exception(error_);
+    }
+    if (deferredOperation_ && !isTrapAllowed)
+    {
+      throw std::domain_error("Arithmetic trap");
+    }
+    if (deferredOperation_)
+    {
+      operands_.push(Operand{calculate(deferredOperation_, deferredFirst_, deferredSecond_), false});
+    }
+    long long result = popOperand();
+    if (!operands_.isEmpty())
+    {
+      throw std::logic_error("bad expression");
+    }
+    return result;
+  }
+
+  template< template< typename > class Storage >
+  void LineEvaluator< Storage >::emit(const Operand& operand)
+  {
+    if (!error_ && !deferredOperation_)
+    {
+      operands_.push(operand);
+    }
+  }
+
+  template< template< typename > class Storage >
+  void LineEvaluator< Storage >::emit(char symbol)
+  {
+    if (error_ || deferredOperation_)
+    {
+      return;
+    }
+    if (symbol == '(')
+    {
+      operands_.push(Operand{0, true});
+      return;
+    }
+    try
+    {
+      long long b = popOperand();
+      long long a = popOperand();
+      if (isTrapping(symbol, a, b))
+      {
+        deferredOperation_ = symbol;
+        deferredFirst_ = a;
+        deferredSecond_ = b;
+        return;
+      }
+      operands_.push(Operand{calculate(symbol, a, b), false});
+    }
+    catch (const std::length_error&)
+    {
+      throw;
+    }
+    catch (const std::exception&)
+    {
+      error_ = std::current_exception();
+    }
+  }
+
+  template< template< typename > class Storage >
+  long long LineEvaluator< Storage >::popOperand()
+  {
+    if (operands_.getTop().isBracket_)
+    {
+      throw std::logic_error("It's not operand!");
+    }
+    long long result = operands_.getTop().value_;
+    operands_.drop();
+    lowest_ = std::min(lowest_, operands_.size());
+    return result;
+  }
+
+  template< typename Evaluator, typename Handler >
+  void scanExpression(std::experimental::string_view line, Evaluator& evaluator, Handler handleSymbol)
+  {
+    long long number = 0;
+    bool isNumber = false;
+    bool isOverflow = false;
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+      const char symbol = line[i];
+      if (symbol == ' ')
+      {
+        continue;
+      }
+      if (std::isalpha(symbol))
+      {
+        throw std::logic_error("The symbol is an alpha\n");
+      }
+      else if (ivlicheva::isBrackets(symbol) || ivlicheva::isMathOperation(symbol))
+      {
+        if (isNumber)
+        {
+          if (isOverflow)
+          {
+            throw std::out_of_range("stoll");
+          }
+          evaluator.pushOperand(number);
+          number = 0;
+          isNumber = false;
+        }
+        i = handleSymbol(i);
+      }
+      else if (std::isdigit(symbol))
+      {
+        const long long digit = symbol - '0';
+        const long long max_int = std::numeric_limits< long long >::max();
+        isOverflow = isOverflow || number > (max_int - digit) / 10;
+        number = isOverflow ? number : number * 10 + digit;
+        isNumber = true;
+      }
+    }
+    if (isNumber)
+    {
+      if (isOverflow)
+      {
+        throw std::out_of_range("stoll");
+      }
+      evaluator.pushOperand(number);
+    }
+  }
+
+  template< typename F >
+  void runTasks(size_t tasks, size_t threads, F task)
+  {
+    std::atomic< size_t > next(0);
+    std::vector< std::exception_ptr > errors(tasks);
+    auto worker = [&]()
+     {
+       for (size_t i = next++; i < tasks; i = next++)
+       {
+         try
+         {
+           task(i);
+         }
+         catch (...)
+         {
+           errors[i] = std::current_exception();
+         }
+       }
+     };
+    std::vector< std::thread > pool;
+    try
+    {
+      for (size_t i = 1; i < threads && i < tasks; ++i)
+      {
+        pool.emplace_back(worker);
+      }
+    }
+    catch (...)
+    {
+      next = tasks;
+      for (auto&& thread: pool)
+      {
+        thread.join();
+      }
+      throw;
+    }
+    worker();
+    for (auto&& thread: pool)
+    {
+      thread.join();
+    }
+    for (auto&& error: errors)
+    {
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  struct Span
+  {
+    size_t begin_;
+    size_t end_;
+    uint64_t hash_;
+  };
+
+  struct OpenedSpan
+  {
+    size_t span_;
+    uint64_t prefix_;
+  };
+
+  struct Subexpression
+  {
+    size_t span_;
+    long long value_;
+  };
+
+  struct ChunkError
+  {
+    std::exception_ptr error_;
+    size_t line_;
+  };
+
 }
 
 bool ivlicheva::isBrackets(char s)
@@ -86,19 +478,20 @@ bool ivlicheva::isMathOperation(char s)
 }
 
 ivlicheva::Queue< std::string > ivlicheva::readFromStream(std::istream& stream)
+{
+  MappedLineReader reader(stream);
+  return readFromStream(reader);
+}
+
+ivlicheva::Queue< std::string > ivlicheva::readFromStream(MappedLineReader& stream)
 {
   ivlicheva::Queue< std::string > inputsQueue;
-  while (!stream.eof())
+  std::experimental::string_view str;
+  while (stream.getLine(str))
   {
-    if (stream.peek() && stream.eof())
-    {
-      break;
-    }
-    std::string str = "";
-    std::getline(stream, str);
     if (!str.empty())
     {
-      inputsQueue.push(str);
+      inputsQueue.push(str.to_string());
     }
   }
   return inputsQueue;
@@ -111,10 +504,77 @@ ivlicheva::Stack< long long > ivlicheva::convertExpressions(ivlicheva::Queue< st
   {
     std::string str = inputsQueue.getNext();
     inputsQueue.drop();
-    ivlicheva::Queue< ExpressionPart > queue;
-    queue = splitStringToExpression(str);
-    translateFromInfixToPostfixExpression(queue);
-    output.push(calculateExpression(queue));
+    output.push(evaluateExpression(str));
+  }
+  return output;
+}
+
+ivlicheva::Stack< long long > ivlicheva::convertExpressions(ivlicheva::Queue< std::string > inputsQueue, ExpressionCache& cache)
+{
+  ivlicheva::Stack< long long > output;
+  while (!inputsQueue.isEmpty())
+  {
+    std::string str = inputsQueue.getNext();
+    inputsQueue.drop();
+    output.push(cache.evaluate(str));
+  }
+  return output;
+}
+
+ivlicheva::Stack< long long > ivlicheva::convertExpressions(ivlicheva::Queue< std::string > inputsQueue, size_t threads, bool isDag)
+{
+  std::vector< std::string > lines;
+  while (!inputsQueue.isEmpty())
+  {
+    lines.push_back(inputsQueue.getNext());
+    inputsQueue.drop();
+  }
+  threads = threads ? threads : std::max< size_t >(std::thread::hardware_concurrency(), 1);
+  const size_t chunk = std::max< size_t >(lines.size() / (threads * 8), 1);
+  const size_t tasks = (lines.size() + chunk - 1) / chunk;
+  std::vector< long long > results(lines.size());
+  std::vector< char > isDeferred(lines.size());
+  std::vector< ChunkError > errors(tasks, ChunkError{nullptr, 0});
+  std::atomic< size_t > firstFailed(tasks);
+  runTasks(tasks, threads, [&](size_t task)
+   {
+     ExpressionCache cache(65536, 32, false, isDag);
+     const size_t last = std::min(lines.size(), (task + 1) * chunk);
+     for (size_t i = task * chunk; i < last && task < firstFailed; ++i)
+     {
+       try
+       {
+         results[i] = cache.evaluate(lines[i]);
+       }
+       catch (const std::domain_error&)
+       {
+         isDeferred[i] = true;
+       }
+       catch (const std::exception&)
+       {
+         errors[task] = ChunkError{std::current_exception(), i};
+         size_t failed = firstFailed;
+         while (task < failed && !firstFailed.compare_exchange_weak(failed, task))
+         {}
+       }
+     }
+   });
+  ivlicheva::Stack< long long > output;
+  for (size_t task = 0; task < tasks; ++task)
+  {
+    const size_t last = errors[task].error_ ? errors[task].line_ : std::min(lines.size(), (task + 1) * chunk);
+    for (size_t i = task * chunk; i < last; ++i)
+    {
+      if (isDeferred[i])
+      {
+        results[i] = isDag ? evaluateExpressionDag(lines[i]) : evaluateExpression(lines[i]);
+      }
+      output.push(results[i]);
+    }
+    if (errors[task].error_)
+    {
+      std::rethrow_exception(errors[task].error_);
+    }
   }
   return output;
 }
@@ -133,6 +593,29 @@ void ivlicheva::outputExpressions(std::ostream& stream, ivlicheva::Stack< long l
   stream << '\n';
 }
 
+void ivlicheva::streamExpressions(MappedLineReader& stream, std::ostream& out, bool isDag)
+{
+  ivlicheva::SpillStack< long long, 4096 > output;
+  std::experimental::string_view str;
+  while (stream.getLine(str))
+  {
+    if (!str.empty())
+    {
+      output.push(isDag ? evaluateExpressionDag(str) : evaluateExpression(str));
+    }
+  }
+  while (!output.isEmpty())
+  {
+    out << output.getTop();
+    output.drop();
+    if (!output.isEmpty())
+    {
+      out << ' ';
+    }
+  }
+  out << '\n';
+}
+
 ivlicheva::Queue< ivlicheva::ExpressionPart > ivlicheva::translateFromInfixToPostfixExpression(Queue< ExpressionPart >& queue)
 {
   Queue< ExpressionPart > queueNew;
@@ -236,46 +719,13 @@ long long ivlicheva::calculateExpression(Queue< ExpressionPart >& queue)
   {
     ExpressionPart cell = queue.getNext();
     queue.drop();
-    long long a = 0, b = 0;
     if (cell.getType() == ivlicheva::ExpressionPartType::OPERATION)
     {
-      b = stack.getTop().getOperand();
+      long long b = stack.getTop().getOperand();
       stack.drop();
-      a = stack.getTop().getOperand();
+      long long a = stack.getTop().getOperand();
       stack.drop();
-    }
-    if (cell == ExpressionPart('-'))
-    {
-      stack.push(ExpressionPart(::sum(a, b * (-1))));
-    }
-    else if (cell == ExpressionPart('+'))
-    {
-      stack.push(ExpressionPart(::sum(a, b)));
-    }
-    else if (cell == ExpressionPart('*'))
-    {
-      stack.push(ExpressionPart(::mult(a, b)));
-    }
-    else if (cell == ExpressionPart('/'))
-    {
-      if (b == 0)
-      {
-        throw std::logic_error("Error. Division by zero");
-      }
-      stack.push(ExpressionPart(a / b));
-    }
-    else if (cell == ExpressionPart('%'))
-    {
-      long long result = 0;
-      if (a < 0)
-      {
-        result = a + b * (std::abs(a) / b + 1);
-      }
-      else
-      {
-        result = a % b;
-      }
-      stack.push(ExpressionPart(result));
+      stack.push(ExpressionPart(::calculate(cell.getOperation(), a, b)));
     }
     else
     {
@@ -291,3 +741,103 @@ long long ivlicheva::calculateExpression(Queue< ExpressionPart >& queue)
 
   return result;
 }
+
+long long ivlicheva::evaluateExpression(std::experimental::string_view line, bool isTrapAllowed)
+{
+  try
+  {
+    LineEvaluator< FixedStorage > evaluator;
+    scanExpression(line, evaluator, [&evaluator, line](size_t i)
+     {
+       evaluator.pushSymbol(line[i]);
+       return i;
+     });
+    return evaluator.getResult(isTrapAllowed);
+  }
+  catch (const std::length_error&)
+  {
+    if (!isTrapAllowed)
+    {
+      throw std::domain_error("Arithmetic trap");
+    }
+    std::string str = line.to_string();
+    Queue< ExpressionPart > queue = splitStringToExpression(str);
+    translateFromInfixToPostfixExpression(queue);
+    return calculateExpression(queue);
+  }
+}
+
+long long ivlicheva::evaluateExpressionDag(std::experimental::string_view line, bool isTrapAllowed)
+{
+  if (line.size() < fixedCapacity)
+  {
+    return evaluateExpression(line, isTrapAllowed);
+  }
+  const size_t npos = std::experimental::string_view::npos;
+  const uint64_t hashBase = 0x100000001B3;
+  std::vector< Span > spans;
+  GrowingStack< OpenedSpan > opened;
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < line.size(); ++i)
+  {
+    if (line[i] == '(')
+    {
+      opened.push(OpenedSpan{spans.size(), prefix});
+      spans.push_back(Span{i, npos, 0});
+    }
+    prefix = prefix * hashBase + static_cast< unsigned char >(line[i]);
+    if (line[i] == ')' && !opened.isEmpty())
+    {
+      Span& span = spans[opened.getTop().span_];
+      uint64_t power = 1;
+      uint64_t base = hashBase;
+      for (size_t length = i + 1 - span.begin_; length; length >>= 1)
+      {
+        power = (length & 1) ? power * base : power;
+        base *= base;
+      }
+      span.end_ = i;
+      span.hash_ = prefix - opened.getTop().prefix_ * power;
+      opened.drop();
+    }
+  }
+  HashDictionary< uint64_t, Subexpression > subexpressions;
+  LineEvaluator< GrowingStack > evaluator;
+  size_t next = 0;
+  scanExpression(line, evaluator, [&](size_t i)
+   {
+     if (line[i] == '(' && spans[next].end_ != npos)
+     {
+       const Span& span = spans[next++];
+       auto iter = subexpressions.find(span.hash_);
+       if (iter != subexpressions.end())
+       {
+         const Span& other = spans[iter->second.span_];
+         const size_t length = span.end_ + 1 - span.begin_;
+         if (other.end_ + 1 - other.begin_ == length && !line.substr(other.begin_, length).compare(line.substr(i, length)))
+         {
+           evaluator.pushOperand(iter->second.value_);
+           while (next < spans.size() && spans[next].begin_ < span.end_)
+           {
+             ++next;
+           }
+           return span.end_;
+         }
+       }
+       evaluator.openGroup(next - 1);
+     }
+     else if (line[i] == '(')
+     {
+       ++next;
+     }
+     evaluator.pushSymbol(line[i]);
+     size_t span = 0;
+     long long value = 0;
+     if (line[i] == ')' && evaluator.closeGroup(span, value))
+     {
+       subexpressions.tryEmplace(spans[span].hash_, Subexpression{span, value});
+     }
+     return i;
+   });
+  return evaluator.getResult(isTrapAllowed);
+}
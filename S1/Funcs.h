@@ -2,18 +2,27 @@
 #define FUNCS_H
 
 #include <string>
+#include <experimental/string_view>
 #include "Queue.h"
 #include "Stack.h"
 #include "ExpressionPart.h"
+#include "ExpressionCache.h"
+#include "MappedLineReader.h"
 
 namespace ivlicheva
 {
   Queue< std::string > readFromStream(std::istream& stream);
+  Queue< std::string > readFromStream(MappedLineReader& stream);
   Stack< long long > convertExpressions(Queue< std::string > inputsQueue);
+  Stack< long long > convertExpressions(Queue< std::string > inputsQueue, ExpressionCache& cache);
+  Stack< long long > convertExpressions(Queue< std::string > inputsQueue, size_t threads, bool isDag = false);
   void outputExpressions(std::ostream& stream, Stack< long long > output);
+  void streamExpressions(MappedLineReader& stream, std::ostream& out, bool isDag = false);
   Queue< ExpressionPart > translateFromInfixToPostfixExpression(Queue< ExpressionPart >& queue);
   Queue< ExpressionPart > splitStringToExpression(std::string& str);
   long long calculateExpression(Queue< ExpressionPart >& queue);
+  long long evaluateExpression(std::experimental::string_view line, bool isTrapAllowed = true);
+  long long evaluateExpressionDag(std::experimental::string_view line, bool isTrapAllowed = true);
   bool isBrackets(char);
   bool isMathOperation(char);
 }
@@ -0,0 +1,76 @@
+#ifndef GROWINGSTACK_H
+#define GROWINGSTACK_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace ivlicheva
+{
+  template< typename T >
+  class GrowingStack
+  {
+    public:
+      GrowingStack() = default;
+      GrowingStack(const GrowingStack< T >&) = default;
+      ~GrowingStack() = default;
+
+      GrowingStack< T >& operator=(const GrowingStack< T >&) = default;
+
+      void push(const T& value);
+      void drop();
+      void clear() noexcept;
+      const T& getTop() const;
+      bool isEmpty() const noexcept;
+      size_t size() const noexcept;
+
+    private:
+      std::vector< T > data_;
+  };
+}
+
+template< typename T >
+void ivlicheva::GrowingStack< T >::push(const T& value)
+{
+  data_.push_back(value);
+}
+
+template< typename T >
+void ivlicheva::GrowingStack< T >::drop()
+{
+  if (data_.empty())
+  {
+    throw std::logic_error("It is empty");
+  }
+  data_.pop_back();
+}
+
+template< typename T >
+void ivlicheva::GrowingStack< T >::clear() noexcept
+{
+  data_.clear();
+}
+
+template< typename T >
+const T& ivlicheva::GrowingStack< T >::getTop() const
+{
+  if (data_.empty())
+  {
+    throw std::logic_error("It is empty");
+  }
+  return data_.back();
+}
+
+template< typename T >
+bool ivlicheva::GrowingStack< T >::isEmpty() const noexcept
+{
+  return data_.empty();
+}
+
+template< typename T >
+size_t ivlicheva::GrowingStack< T >::size() const noexcept
+{
+  return data_.size();
+}
+
+#endif
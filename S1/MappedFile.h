@@ -0,0 +1,31 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace ivlicheva
+{
+  class MappedFile
+  {
+    public:
+      MappedFile() noexcept;
+      explicit MappedFile(const std::string&);
+      MappedFile(const MappedFile&) = delete;
+      MappedFile(MappedFile&&) noexcept;
+      ~MappedFile();
+
+      MappedFile& operator=(const MappedFile&) = delete;
+      MappedFile& operator=(MappedFile&&) noexcept;
+
+      void swap(MappedFile&) noexcept;
+      const char* data() const noexcept;
+      size_t size() const noexcept;
+
+    private:
+      const char* data_;
+      size_t size_;
+  };
+}
+
+#endif
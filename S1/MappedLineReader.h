@@ -0,0 +1,38 @@
+#ifndef MAPPEDLINEREADER_H
+#define MAPPEDLINEREADER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <experimental/string_view>
+#include "MappedFile.h"
+
+namespace ivlicheva
+{
+  class MappedLineReader
+  {
+    public:
+      explicit MappedLineReader(const std::string& path);
+      explicit MappedLineReader(std::istream& in);
+      MappedLineReader(const MappedLineReader&) = delete;
+      ~MappedLineReader() = default;
+
+      MappedLineReader& operator=(const MappedLineReader&) = delete;
+
+      bool getLine(std::experimental::string_view& line);
+
+    private:
+      static constexpr size_t bufferSize = 1 << 20;
+      MappedFile file_;
+      std::istream* in_;
+      std::unique_ptr< char[] > buffer_;
+      size_t capacity_;
+      const char* begin_;
+      const char* end_;
+
+      bool refill();
+  };
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef SPILLSTACK_H
+#define SPILLSTACK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ivlicheva
+{
+  template< typename T, size_t N >
+  class SpillStack
+  {
+    public:
+      static_assert(std::is_trivially_copyable< T >::value, "SpillStack needs trivially copyable values");
+
+      SpillStack();
+      SpillStack(const SpillStack< T, N >&) = delete;
+      ~SpillStack();
+
+      SpillStack< T, N >& operator=(const SpillStack< T, N >&) = delete;
+
+      void push(const T& value);
+      void drop();
+      const T& getTop() const;
+      bool isEmpty() const noexcept;
+      size_t getSpilledBlocks() const noexcept;
+
+    private:
+      mutable T data_[N];
+      mutable size_t size_;
+      mutable size_t spilled_;
+      std::FILE* file_;
+
+      void spill();
+      void restore() const;
+  };
+}
+
+template< typename T, size_t N >
+ivlicheva::SpillStack< T, N >::SpillStack():
+  size_(0),
+  spilled_(0),
+  file_(nullptr)
+{}
+
+template< typename T, size_t N >
+ivlicheva::SpillStack< T, N >::~SpillStack()
+{
+  if (file_)
+  {
+    std::fclose(file_);
+  }
+}
+
+template< typename T, size_t N >
+void ivlicheva::SpillStack< T, N >::push(const T& value)
+{
+  if (size_ == N)
+  {
+    spill();
+  }
+  data_[size_++] = value;
+}
+
+template< typename T, size_t N >
+void ivlicheva::SpillStack< T, N >::drop()
+{
+  if (isEmpty())
+  {
+    throw std::logic_error("It is empty");
+  }
+  if (!size_)
+  {
+    restore();
+  }
+  --size_;
+}
+
+template< typename T, size_t N >
+const T& ivlicheva::SpillStack< T, N >::getTop() const
+{
+  if (isEmpty())
+  {
+    throw std::logic_error("It is empty");
+  }
+  if (!size_)
+  {
+    restore();
+  }
+  return data_[size_ - 1];
+}
+
+template< typename T, size_t N >
+bool ivlicheva::SpillStack< T, N >::isEmpty() const noexcept
+{
+  return !size_ && !spilled_;
+}
+
+template< typename T, size_t N >
+size_t ivlicheva::SpillStack< T, N >::getSpilledBlocks() const noexcept
+{
+  return spilled_;
+}
+
+template< typename T, size_t N >
+void ivlicheva::SpillStack< T, N >::spill()
+{
+  if (!file_)
+  {
+    file_ = std::tmpfile();
+    if (!file_)
+    {
+      throw std::logic_error("Bad spill file");
+    }
+  }
+  if (std::fseek(file_, static_cast< long >(spilled_ * sizeof(data_)), SEEK_SET) || std::fwrite(data_, sizeof(data_), 1, file_) != 1)
+  {
+    throw std::logic_error("Bad spill file");
+  }
+  ++spilled_;
+  size_ = 0;
+}
+
+template< typename T, size_t N >
+void ivlicheva::SpillStack< T, N >::restore() const
+{
+  --spilled_;
+  if (std::fseek(file_, static_cast< long >(spilled_ * sizeof(data_)), SEEK_SET) || std::fread(data_, sizeof(data_), 1, file_) != 1)
+  {
+    ++spilled_;
+    throw std::logic_error("Bad spill file");
+  }
+  size_ = N;
+}
+
+#endif
@@ -1,51 +1,128 @@
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include "Queue.h"
 #include "Stack.h"
 #include "Funcs.h"
+#include "MappedLineReader.h"
 
-int main(int argc, char** argv)
+namespace
 {
-  ivlicheva::Queue< std::string > queue;
-  if (argc == 2)
+  void printCacheStats(std::ostream& out, const ivlicheva::ExpressionCache& cache, bool isEnabled)
   {
-    std::string fileName = argv[1];
-    std::ifstream file(fileName);
-    if (file.is_open())
+    if (isEnabled)
     {
-      queue = ivlicheva::readFromStream(file);
+      out << "cache: hits " << cache.getHits() << ", misses " << cache.getMisses() << '\n';
     }
-    else
+  }
+
+  int runStreaming(ivlicheva::MappedLineReader& in, bool isDag)
+  {
+    try
     {
-      std::cerr << "Error. File is not open.";
+      ivlicheva::streamExpressions(in, std::cout, isDag);
     }
-    file.close();
-    if (!file)
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+      return 2;
+    }
+    return 0;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  bool isCacheStats = argc > 1 && std::string(argv[argc - 1]) == "--cache-stats";
+  if (isCacheStats)
+  {
+    --argc;
+  }
+  bool isDag = argc > 1 && std::string(argv[argc - 1]) == "--dag";
+  if (isDag)
+  {
+    --argc;
+  }
+  size_t threads = 0;
+  bool isThreaded = argc > 2 && std::string(argv[argc - 2]) == "--threads";
+  if (isThreaded)
+  {
+    std::string count = argv[argc - 1];
+    if (count.empty() || count.size() > 4 || count.find_first_not_of("0123456789") != count.npos)
     {
-      std::cerr << "Error. File is open";
+      std::cerr << "Bad args\n";
+      return 1;
     }
+    threads = std::stoul(count);
+    argc -= 2;
   }
-  else if (argc == 1)
+  bool isStreaming = !isThreaded && argc > 1 && std::string(argv[argc - 1]) == "--stream";
+  if (isStreaming)
   {
-    queue = ivlicheva::readFromStream(std::cin);
+    --argc;
   }
-  else
+  if (argc != 1 && argc != 2)
   {
     std::cerr << "Bad args\n";
     return 1;
   }
+  std::istringstream none;
+  std::ifstream file;
+  std::unique_ptr< ivlicheva::MappedLineReader > reader;
+  try
+  {
+    if (argc == 1)
+    {
+      reader.reset(new ivlicheva::MappedLineReader(std::cin));
+    }
+    else if (isStreaming)
+    {
+      file.open(argv[1]);
+      if (!file.is_open())
+      {
+        throw std::logic_error("Bad file");
+      }
+      reader.reset(new ivlicheva::MappedLineReader(file));
+    }
+    else
+    {
+      reader.reset(new ivlicheva::MappedLineReader(std::string(argv[1])));
+    }
+  }
+  catch (const std::exception&)
+  {
+    std::cerr << "Error. File is not open.";
+    reader.reset(new ivlicheva::MappedLineReader(none));
+  }
+  if (isStreaming)
+  {
+    return runStreaming(*reader, isDag);
+  }
+  ivlicheva::Queue< std::string > queue = ivlicheva::readFromStream(*reader);
+  reader.reset();
+  ivlicheva::ExpressionCache cache(65536, 32, true, isDag);
   try
   {
     ivlicheva::Stack< long long > stack;
-    stack = ivlicheva::convertExpressions(queue);
+    if (isThreaded)
+    {
+      stack = ivlicheva::convertExpressions(queue, threads, isDag);
+    }
+    else
+    {
+      stack = ivlicheva::convertExpressions(queue, cache);
+    }
     ivlicheva::outputExpressions(std::cout, stack);
   }
   catch (const std::exception& e)
   {
     std::cerr << e.what() << '\n';
+    printCacheStats(std::cerr, cache, isCacheStats && !isThreaded);
     return 2;
   }
+  printCacheStats(std::cerr, cache, isCacheStats && !isThreaded);
 
   return 0;
 }
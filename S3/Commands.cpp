@@ -2,7 +2,8 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include "Dictionary.h"
+#include <utility>
+#include "HashDictionary.h"
 #include "BidirectionalList.h"
 #include "iolists.h"
 #include "IOParse.h"
@@ -114,7 +115,7 @@ void ivlicheva::Commands::concat(std::string str)
   {
     throw std::logic_error("Not enough args");
   }
-  lists_.push(nameNew, list);
+  lists_.tryEmplace(nameNew, std::move(list));
 }
 
 void ivlicheva::Commands::equal(std::string str)
@@ -2,7 +2,7 @@
 #define COMMANDS_H
 
 #include <string>
-#include "Dictionary.h"
+#include "HashDictionary.h"
 #include "BidirectionalList.h"
 
 namespace ivlicheva
@@ -10,7 +10,7 @@ namespace ivlicheva
   struct Commands
   {
     using list_t = BidirectionalList< long long >;
-    using lists_t = Dictionary< std::string, list_t, std::less< std::string > >;
+    using lists_t = HashDictionary< std::string, list_t, StringHash, StringEqual >;
     using list_iter_t = list_t::Iterator;
 
     Commands(const lists_t&, std::ostream&);
@@ -1,22 +1,23 @@
 #include "iolists.h"
-#include <fstream>
 #include <string>
+#include <utility>
+#include <experimental/string_view>
 #include "BidirectionalList.h"
-#include "Dictionary.h"
+#include "HashDictionary.h"
+#include "MappedLineReader.h"
 #include "IOParse.h"
 #include "parselist.h"
 
-ivlicheva::dictionary_t ivlicheva::readListsFromFile(std::ifstream& file)
+ivlicheva::dictionary_t ivlicheva::readListsFromFile(MappedLineReader& file)
 {
   dictionary_t dictionary;
-  while (!file.eof())
+  std::experimental::string_view str;
+  while (file.getLine(str))
   {
-    std::string str = "";
-    std::getline(file, str);
     if (str.size())
     {
-      std::string name = getSubstring(str);
-      dictionary.push(name, splitStringToList(str));
+      std::string name = takeWord(str).to_string();
+      dictionary.tryEmplace(std::move(name), splitStringToList(str));
     }
   }
   return dictionary;
@@ -1,16 +1,16 @@
 #ifndef IOLISTS_H
 #define IOLISTS_H
 
-#include <fstream>
 #include <string>
 #include "BidirectionalList.h"
-#include "Dictionary.h"
+#include "HashDictionary.h"
+#include "MappedLineReader.h"
 
 namespace ivlicheva
 {
   using list_t = BidirectionalList< long long >;
-  using dictionary_t = Dictionary< std::string, list_t, std::less< std::string > >;
-  dictionary_t readListsFromFile(std::ifstream&);
+  using dictionary_t = HashDictionary< std::string, list_t, StringHash, StringEqual >;
+  dictionary_t readListsFromFile(MappedLineReader&);
 }
 
 #endif
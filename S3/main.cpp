@@ -1,9 +1,10 @@
 #include <iostream>
 #include <functional>
-#include <fstream>
+#include <memory>
 #include "BidirectionalList.h"
-#include "Dictionary.h"
+#include "HashDictionary.h"
 #include "iolists.h"
+#include "MappedLineReader.h"
 #include "Commands.h"
 #include "IOParse.h"
 #include "parselist.h"
@@ -18,16 +19,20 @@ int main(int argc, char** argv)
     std::cerr << "Error\n";
     return 1;
   }
-  std::ifstream file(argv[1]);
-  if (!file.is_open())
+  std::unique_ptr< ivlicheva::MappedLineReader > file;
+  try
+  {
+    file.reset(new ivlicheva::MappedLineReader(argv[1]));
+  }
+  catch (const std::exception&)
   {
     std::cerr << "File is not open\n";
     return 1;
   }
-  ivlicheva::Commands funcs(ivlicheva::readListsFromFile(file), std::cout);
-  file.close();
+  ivlicheva::Commands funcs(ivlicheva::readListsFromFile(*file), std::cout);
+  file.reset();
 
-  ivlicheva::Dictionary< std::string, command_t, std::less< std::string > > dictionaryOfCommands(
+  ivlicheva::HashDictionary< std::string, command_t, ivlicheva::StringHash, ivlicheva::StringEqual > dictionaryOfCommands(
     {
       {"print", std::bind(&ivlicheva::Commands::print, &funcs, std::placeholders::_1)},
       {"replace", std::bind(&ivlicheva::Commands::replace, &funcs, std::placeholders::_1)},
@@ -46,7 +51,7 @@ int main(int argc, char** argv)
       std::string arguments = command.substr(n + 1);
       try
       {
-        dictionaryOfCommands.get(command.substr(0, n))(arguments);
+        dictionaryOfCommands.get(ivlicheva::getWord(command))(arguments);
       }
       catch (const std::exception&)
       {
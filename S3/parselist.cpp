@@ -1,20 +1,16 @@
 #include "parselist.h"
 #include <string>
+#include <experimental/string_view>
 #include <stdexcept>
 #include "IOParse.h"
 
-ivlicheva::list_t ivlicheva::splitStringToList(std::string& str)
+ivlicheva::list_t ivlicheva::splitStringToList(std::experimental::string_view str)
 {
   list_t list;
-  if (str.empty())
-  {
-    return list;
-  }
   list_t::Iterator iter = list.beforeBegin();
   while (!str.empty())
   {
-    std::string newNumber = getSubstring(str);
-    list.pushAfter(std::stoll(newNumber), iter);
+    list.pushAfter(std::stoll(takeWord(str).to_string()), iter);
     ++iter;
   }
   return list;
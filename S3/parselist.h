@@ -2,11 +2,12 @@
 #define PARSELIST_H
 
 #include <string>
+#include <experimental/string_view>
 #include "iolists.h"
 
 namespace ivlicheva
 {
-  list_t splitStringToList(std::string&);
+  list_t splitStringToList(std::experimental::string_view);
 }
 
 #endif
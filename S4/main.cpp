@@ -1,32 +1,66 @@
 #include <iostream>
-#include <fstream>
+#include <memory>
 #include <string>
 #include <functional>
-#include "Dictionary.h"
+#include "HashDictionary.h"
 #include "IODataset.h"
+#include "MappedLineReader.h"
 #include "iomessages.h"
 #include "CommandsS2.h"
 #include "IOParse.h"
+#include "Snapshot.h"
 
 int main(int argc, char** argv)
 {
   using command_t = std::function< void(std::string) >;
 
-  if (argc != 2)
+  if (argc != 2 && !(argc == 4 && std::string(argv[2]) == "--save-snapshot"))
   {
     std::cerr << "Error\n";
     return 1;
   }
-  std::ifstream file(argv[1]);
-  if (!file.is_open())
+  ivlicheva::dictionaries_t dictionaries;
+  if (ivlicheva::isSnapshot(argv[1]))
   {
-    std::cerr << "File is not open\n";
-    return 1;
+    try
+    {
+      dictionaries = ivlicheva::readDictionariesFromSnapshot(argv[1]);
+    }
+    catch (const std::exception&)
+    {
+      std::cerr << "Bad snapshot\n";
+      return 1;
+    }
+  }
+  else
+  {
+    std::unique_ptr< ivlicheva::MappedLineReader > file;
+    try
+    {
+      file.reset(new ivlicheva::MappedLineReader(argv[1]));
+    }
+    catch (const std::exception&)
+    {
+      std::cerr << "File is not open\n";
+      return 1;
+    }
+    dictionaries = ivlicheva::readDictionariesFromFile(*file);
+  }
+  if (argc == 4)
+  {
+    try
+    {
+      ivlicheva::writeDictionariesToSnapshot(argv[3], dictionaries);
+    }
+    catch (const std::exception&)
+    {
+      std::cerr << "Bad snapshot\n";
+      return 1;
+    }
   }
-  ivlicheva::Commands funcs(ivlicheva::readDictionariesFromFile(file), std::cout);
-  file.close();
+  ivlicheva::Commands funcs(dictionaries, std::cout);
 
-  ivlicheva::Dictionary< std::string, command_t, std::less< std::string > > dictionaryOfCommands(
+  ivlicheva::HashDictionary< std::string, command_t, ivlicheva::StringHash, ivlicheva::StringEqual > dictionaryOfCommands(
    {
      {"print", std::bind(&ivlicheva::Commands::output, &funcs, std::placeholders::_1)},
      {"complement", std::bind(&ivlicheva::Commands::complement, &funcs, std::placeholders::_1)},
@@ -40,10 +74,11 @@ int main(int argc, char** argv)
     std::getline(std::cin, command);
     if (command.size())
     {
-      std::string name = ivlicheva::getSubstring(command);
       try
       {
-        dictionaryOfCommands.get(name)(command);
+        command_t& func = dictionaryOfCommands.get(ivlicheva::getWord(command));
+        ivlicheva::dropWord(command);
+        func(command);
       }
       catch (const std::exception&)
       {
@@ -1,9 +1,10 @@
 #include "iotree.h"
 #include <iostream>
+#include <utility>
 
-ivlicheva::BinarySearchTree< long long, std::string, std::less< long long > > ivlicheva::readTreeFromStream(std::istream& stream)
+ivlicheva::tree_t ivlicheva::readTreeFromStream(std::istream& stream)
 {
-  BinarySearchTree< long long, std::string, std::less< long long > > tree;
+  tree_t tree;
   while (!stream.eof() && !stream.fail())
   {
     long long k1 = 0;
@@ -11,7 +12,7 @@ ivlicheva::BinarySearchTree< long long, std::string, std::less< long long > > iv
     stream >> k1 >> k2;
     if (!stream.fail())
     {
-      tree.push(k1, k2);
+      tree.emplace(k1, std::move(k2));
     }
   }
   return tree;
@@ -7,7 +7,8 @@
 
 namespace ivlicheva
 {
-  BinarySearchTree< long long, std::string, std::less< long long > > readTreeFromStream(std::istream&);
+  using tree_t = BinarySearchTree< long long, std::string, std::less< long long >, RangeAggregate< KeySum< __int128 > > >;
+  tree_t readTreeFromStream(std::istream&);
 }
 
 #endif
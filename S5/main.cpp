@@ -2,6 +2,7 @@
 #include <fstream>
 #include <string>
 #include <utility>
+#include <limits>
 #include "BinarySearchTree.h"
 #include "iofunctional.h"
 #include "summation.h"
@@ -30,34 +31,124 @@ namespace
     sum_(data);
     print_(data);
   }
+
+  void printTreeStats(std::ostream& out, const ivlicheva::tree_t& tree)
+  {
+    ivlicheva::TreeShape shape = tree.shapeStats();
+    out << "size " << shape.size_ << ", height " << shape.height_ << ", black height " << shape.blackHeight_;
+    out << ", depth avg " << shape.averageDepth_ << " max " << shape.maxDepth_;
+    out << ", turns left " << shape.leftTurns_ << " right " << shape.rightTurns_;
+    try
+    {
+      tree.validate();
+      out << ", valid\n";
+    }
+    catch (const std::exception& e)
+    {
+      out << ", invalid: " << e.what() << '\n';
+    }
+  }
 }
 
 int main(int argc, char** argv)
 {
-  if (argc != 3)
+  bool isTreeStats = argc > 1 && std::string(argv[argc - 1]) == "--tree-stats";
+  if (isTreeStats)
+  {
+    --argc;
+  }
+  if (argc < 3 || argc > 5)
   {
     std::cerr << "bad args\n";
     return 1;
   }
   std::string arg = argv[1];
-  if (arg != "ascending" && arg != "descending" && arg != "breadth")
+  bool isPositional = arg == "kth" || arg == "median";
+  if (arg != "ascending" && arg != "descending" && arg != "breadth" && arg != "range" && !isPositional)
   {
     std::cerr << "bad arg\n";
     return 1;
   }
-  std::ifstream file(argv[2]);
+  if (argc != (arg == "kth" ? 4 : arg == "range" ? 5 : 3))
+  {
+    std::cerr << "bad args\n";
+    return 1;
+  }
+  size_t k = 0;
+  if (arg == "kth")
+  {
+    try
+    {
+      k = std::stoull(argv[2]);
+    }
+    catch (const std::exception&)
+    {}
+    if (k == 0)
+    {
+      std::cerr << "bad arg\n";
+      return 1;
+    }
+  }
+  long long lo = 0;
+  long long hi = 0;
+  if (arg == "range")
+  {
+    try
+    {
+      lo = std::stoll(argv[2]);
+      hi = std::stoll(argv[3]);
+    }
+    catch (const std::exception&)
+    {
+      std::cerr << "bad arg\n";
+      return 1;
+    }
+  }
+  std::ifstream file(argv[argc - 1]);
   if (!file.is_open())
   {
     std::cerr << "file is not open\n";
     return 1;
   }
-  ivlicheva::BinarySearchTree< long long, std::string, std::less< long long > > tree = ivlicheva::readTreeFromStream(file);
+  ivlicheva::tree_t tree = ivlicheva::readTreeFromStream(file);
   file.close();
+  if (isTreeStats)
+  {
+    printTreeStats(std::cerr, tree);
+  }
   if (tree.isEmpty())
   {
     std::cout << "<EMPTY>\n";
     return 0;
   }
+  if (isPositional)
+  {
+    size_t index = (arg == "median") ? (tree.size() - 1) / 2 : k - 1;
+    ivlicheva::tree_t::Iterator iter = tree.select(index);
+    if (iter == tree.end())
+    {
+      std::cerr << "bad index\n";
+      return 1;
+    }
+    std::cout << iter->first << ' ' << iter->second << '\n';
+    return 0;
+  }
+  if (arg == "range")
+  {
+    ivlicheva::tree_t::augment_t range = tree.aggregate(lo, hi);
+    if (range.count_ == 0)
+    {
+      std::cout << "<EMPTY>\n";
+      return 0;
+    }
+    if (range.value_ > std::numeric_limits< long long >::max() || range.value_ < std::numeric_limits< long long >::min())
+    {
+      std::cerr << "Overflow\n";
+      return 2;
+    }
+    std::cout << static_cast< long long >(range.value_) << '\n';
+    return 0;
+  }
   IOsum result;
   try
   {
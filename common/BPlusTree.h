@@ -0,0 +1,1349 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <initializer_list>
+#include <tuple>
+
+namespace ivlicheva
+{
+  template< typename K, typename V, typename C >
+  class BPlusTree
+  {
+    public:
+      class ConstIterator;
+      class Iterator;
+      using data_t = std::pair< K, V >;
+      using this_t = BPlusTree< K, V, C >;
+
+      BPlusTree();
+      BPlusTree(const this_t&);
+      BPlusTree(this_t&&) noexcept;
+      ~BPlusTree();
+
+      this_t& operator=(const this_t&);
+      this_t& operator=(this_t&&) noexcept;
+
+      void swap(this_t&) noexcept;
+      void drop(const K&);
+      template< typename... Args >
+      Iterator emplace(const K&, Args&&...);
+      template< typename... Args >
+      Iterator emplace(K&&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(const K&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(K&&, Args&&...);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(const K&, M&&);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(K&&, M&&);
+      Iterator push(const K&, const V&);
+      Iterator push(K&&, V&&);
+      Iterator upperBound(const K&);
+      Iterator lowerBound(const K&);
+      Iterator find(const K&);
+      Iterator erase(Iterator);
+      void erase(Iterator, Iterator);
+      Iterator insert(const std::pair< K, V >&);
+      Iterator insert(std::pair< K, V >&&);
+      void insert(std::initializer_list< std::pair< K, V > >);
+      template< typename It >
+      void assignSorted(It, It);
+      ConstIterator upperBound(const K&) const;
+      ConstIterator lowerBound(const K&) const;
+      ConstIterator find(const K&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      void drop(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator upperBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator lowerBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator find(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator upperBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator lowerBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator find(const Q&) const;
+      bool isEmpty() const noexcept;
+      size_t size() const noexcept;
+
+      Iterator begin();
+      Iterator end();
+      ConstIterator begin() const;
+      ConstIterator end() const;
+      ConstIterator cbegin() const;
+      ConstIterator cend() const;
+
+      template< typename F >
+      F traverseLNR(F) const;
+      template< typename F >
+      F traverseRNL(F) const;
+      template< typename F >
+      F traverseBreadth(F) const;
+
+    private:
+      static constexpr size_t nodeBytes = 256;
+      static constexpr size_t leafCapacity = nodeBytes / sizeof(data_t) < 4 ? 4 : nodeBytes / sizeof(data_t);
+      static constexpr size_t innerCapacity = nodeBytes / (sizeof(K) + sizeof(void*)) < 4 ? 4 : nodeBytes / (sizeof(K) + sizeof(void*));
+      static constexpr size_t leafMin = leafCapacity / 2;
+      static constexpr size_t innerMin = innerCapacity / 2;
+
+      struct inner_t;
+      struct node_t
+      {
+        inner_t* parent_;
+        size_t count_;
+        bool isLeaf_;
+      };
+      struct leaf_t: node_t
+      {
+        leaf_t* prev_;
+        leaf_t* next_;
+        typename std::aligned_storage< sizeof(data_t), alignof(data_t) >::type data_[leafCapacity];
+      };
+      struct inner_t: node_t
+      {
+        K keys_[innerCapacity];
+        node_t* children_[innerCapacity + 1];
+      };
+
+      node_t* root_;
+      leaf_t* first_;
+      leaf_t* last_;
+      size_t size_;
+      C cmp_;
+
+      void destroy() noexcept;
+      void clear(node_t*) noexcept;
+      void clone(const node_t*, inner_t*, size_t, leaf_t*&);
+      leaf_t* createLeaf(inner_t*);
+      inner_t* createInner(inner_t*);
+      data_t* getSlot(const leaf_t*, size_t) const;
+      void insertAt(leaf_t*, size_t, data_t&&);
+      void removeAt(leaf_t*, size_t);
+      Iterator pushData(data_t&&);
+      template< typename Q >
+      leaf_t* findLeaf(const Q&, bool) const;
+      template< typename Q >
+      size_t getLowerIndex(const leaf_t*, const Q&) const;
+      template< typename Q >
+      size_t getUpperIndex(const leaf_t*, const Q&) const;
+      size_t getChildIndex(const inner_t*, const node_t*) const;
+      void insertIntoParent(node_t*, const K&, node_t*);
+      void removeChild(inner_t*, size_t);
+      void balanceLeaf(leaf_t*, leaf_t*&, size_t&);
+      void balanceInner(inner_t*);
+      ConstIterator makeIterator(leaf_t*, size_t) const;
+      template< typename Q >
+      ConstIterator getFirstNotLess(const Q&) const;
+      template< typename Q >
+      ConstIterator getFirstGreater(const Q&) const;
+      template< typename Q >
+      ConstIterator getEqual(const Q&) const;
+      template< typename K1, typename K2 >
+      bool isLess(const K1&, const K2&) const;
+  };
+
+  struct BPlusBackend
+  {
+    template< typename K, typename V, typename C >
+    using tree_t = BPlusTree< K, V, C >;
+  };
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::BPlusTree< K, V, C >::ConstIterator: public std::iterator< std::bidirectional_iterator_tag, std::pair< K, V > >
+{
+  public:
+    friend class BPlusTree< K, V, C >;
+    using this_t = ConstIterator;
+
+    ConstIterator();
+    ConstIterator(const this_t&) = default;
+    ~ConstIterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+    this_t& operator--();
+    this_t operator--(int);
+
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    leaf_t* leaf_;
+    size_t index_;
+    const BPlusTree< K, V, C >* tree_;
+    ConstIterator(leaf_t*, size_t, const BPlusTree< K, V, C >*);
+};
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::ConstIterator::ConstIterator():
+  leaf_(nullptr),
+  index_(0),
+  tree_(nullptr)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::ConstIterator::ConstIterator(leaf_t* leaf, size_t index, const BPlusTree< K, V, C >* tree):
+  leaf_(leaf),
+  index_(index),
+  tree_(tree)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator& ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator++()
+{
+  if (!leaf_)
+  {
+    throw std::logic_error("Bad leaf");
+  }
+  if (++index_ == leaf_->count_)
+  {
+    leaf_ = leaf_->next_;
+    index_ = 0;
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator& ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator--()
+{
+  leaf_t* leaf = leaf_;
+  size_t index = index_;
+  if (!leaf)
+  {
+    leaf = tree_->last_;
+    index = leaf ? leaf->count_ : 0;
+  }
+  if (leaf && index == 0)
+  {
+    leaf = leaf->prev_;
+    index = leaf ? leaf->count_ : 0;
+  }
+  if (!leaf)
+  {
+    throw std::logic_error("Bad leaf");
+  }
+  leaf_ = leaf;
+  index_ = index - 1;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator--(int)
+{
+  this_t result(*this);
+  --(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::BPlusTree< K, V, C >::data_t& ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator*() const
+{
+  return *tree_->getSlot(leaf_, index_);
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::BPlusTree< K, V, C >::data_t* ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator->() const
+{
+  return tree_->getSlot(leaf_, index_);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator==(const this_t& iter) const
+{
+  return leaf_ == iter.leaf_ && index_ == iter.index_ && tree_ == iter.tree_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::BPlusTree< K, V, C >::ConstIterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::BPlusTree< K, V, C >::Iterator: public std::iterator< std::bidirectional_iterator_tag, std::pair< K, V > >
+{
+  public:
+    friend class BPlusTree< K, V, C >;
+    using this_t = Iterator;
+
+    Iterator();
+    Iterator(const this_t&) = default;
+    Iterator(ConstIterator);
+    ~Iterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+    this_t& operator--();
+    this_t operator--(int);
+
+    data_t& operator*();
+    data_t* operator->();
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    ConstIterator citer_;
+};
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::Iterator::Iterator():
+  citer_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::Iterator::Iterator(ConstIterator citer):
+  citer_(citer)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator& ivlicheva::BPlusTree< K, V, C >::Iterator::operator++()
+{
+  ++citer_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::Iterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator& ivlicheva::BPlusTree< K, V, C >::Iterator::operator--()
+{
+  --citer_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::Iterator::operator--(int)
+{
+  this_t result(*this);
+  --(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::data_t& ivlicheva::BPlusTree< K, V, C >::Iterator::operator*()
+{
+  return const_cast< data_t& >(*citer_);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::data_t* ivlicheva::BPlusTree< K, V, C >::Iterator::operator->()
+{
+  return std::addressof(const_cast< data_t& >(*citer_));
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::BPlusTree< K, V, C >::data_t& ivlicheva::BPlusTree< K, V, C >::Iterator::operator*() const
+{
+  return *citer_;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::BPlusTree< K, V, C >::data_t* ivlicheva::BPlusTree< K, V, C >::Iterator::operator->() const
+{
+  return std::addressof(*citer_);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::BPlusTree< K, V, C >::Iterator::operator==(const this_t& iter) const
+{
+  return citer_ == iter.citer_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::BPlusTree< K, V, C >::Iterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::BPlusTree():
+  root_(nullptr),
+  first_(nullptr),
+  last_(nullptr),
+  size_(0)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::BPlusTree(const this_t& ob):
+  BPlusTree()
+{
+  if (!ob.isEmpty())
+  {
+    try
+    {
+      leaf_t* prev = nullptr;
+      clone(ob.root_, nullptr, 0, prev);
+      last_ = prev;
+      size_ = ob.size_;
+    }
+    catch (...)
+    {
+      destroy();
+      throw;
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::BPlusTree(this_t&& ob) noexcept:
+  root_(ob.root_),
+  first_(ob.first_),
+  last_(ob.last_),
+  size_(ob.size_)
+{
+  ob.root_ = nullptr;
+  ob.first_ = nullptr;
+  ob.last_ = nullptr;
+  ob.size_ = 0;
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >::~BPlusTree()
+{
+  destroy();
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >& ivlicheva::BPlusTree< K, V, C >::operator=(const this_t& ob)
+{
+  if (this != std::addressof(ob))
+  {
+    this_t temp(ob);
+    swap(temp);
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::BPlusTree< K, V, C >& ivlicheva::BPlusTree< K, V, C >::operator=(this_t&& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    this_t tmp(std::move(ob));
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::swap(this_t& ob) noexcept
+{
+  std::swap(root_, ob.root_);
+  std::swap(first_, ob.first_);
+  std::swap(last_, ob.last_);
+  std::swap(size_, ob.size_);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::destroy() noexcept
+{
+  if (root_)
+  {
+    clear(root_);
+  }
+  root_ = nullptr;
+  first_ = nullptr;
+  last_ = nullptr;
+  size_ = 0;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::clear(node_t* node) noexcept
+{
+  if (node->isLeaf_)
+  {
+    leaf_t* leaf = static_cast< leaf_t* >(node);
+    for (size_t i = 0; i < leaf->count_; ++i)
+    {
+      getSlot(leaf, i)->~data_t();
+    }
+    delete leaf;
+    return;
+  }
+  inner_t* inner = static_cast< inner_t* >(node);
+  for (size_t i = 0; i <= inner->count_; ++i)
+  {
+    if (inner->children_[i])
+    {
+      clear(inner->children_[i]);
+    }
+  }
+  delete inner;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::clone(const node_t* node, inner_t* parent, size_t pos, leaf_t*& prev)
+{
+  node_t* copy = nullptr;
+  if (node->isLeaf_)
+  {
+    copy = createLeaf(parent);
+  }
+  else
+  {
+    copy = createInner(parent);
+  }
+  if (parent)
+  {
+    parent->children_[pos] = copy;
+  }
+  else
+  {
+    root_ = copy;
+  }
+  if (node->isLeaf_)
+  {
+    const leaf_t* obLeaf = static_cast< const leaf_t* >(node);
+    leaf_t* leaf = static_cast< leaf_t* >(copy);
+    leaf->prev_ = prev;
+    if (prev)
+    {
+      prev->next_ = leaf;
+    }
+    else
+    {
+      first_ = leaf;
+    }
+    prev = leaf;
+    for (size_t i = 0; i < obLeaf->count_; ++i)
+    {
+      new (getSlot(leaf, i)) data_t(*getSlot(obLeaf, i));
+      ++leaf->count_;
+    }
+    return;
+  }
+  const inner_t* obInner = static_cast< const inner_t* >(node);
+  inner_t* inner = static_cast< inner_t* >(copy);
+  inner->count_ = obInner->count_;
+  for (size_t i = 0; i < obInner->count_; ++i)
+  {
+    inner->keys_[i] = obInner->keys_[i];
+  }
+  for (size_t i = 0; i <= obInner->count_; ++i)
+  {
+    clone(obInner->children_[i], inner, i, prev);
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::leaf_t* ivlicheva::BPlusTree< K, V, C >::createLeaf(inner_t* parent)
+{
+  leaf_t* leaf = new leaf_t;
+  leaf->parent_ = parent;
+  leaf->count_ = 0;
+  leaf->isLeaf_ = true;
+  leaf->prev_ = nullptr;
+  leaf->next_ = nullptr;
+  return leaf;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::inner_t* ivlicheva::BPlusTree< K, V, C >::createInner(inner_t* parent)
+{
+  inner_t* inner = new inner_t();
+  inner->parent_ = parent;
+  inner->count_ = 0;
+  inner->isLeaf_ = false;
+  return inner;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::data_t* ivlicheva::BPlusTree< K, V, C >::getSlot(const leaf_t* leaf, size_t i) const
+{
+  return reinterpret_cast< data_t* >(const_cast< leaf_t* >(leaf)->data_ + i);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::insertAt(leaf_t* leaf, size_t i, data_t&& data)
+{
+  for (size_t j = leaf->count_; j > i; --j)
+  {
+    new (getSlot(leaf, j)) data_t(std::move(*getSlot(leaf, j - 1)));
+    getSlot(leaf, j - 1)->~data_t();
+  }
+  new (getSlot(leaf, i)) data_t(std::move(data));
+  ++leaf->count_;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::removeAt(leaf_t* leaf, size_t i)
+{
+  getSlot(leaf, i)->~data_t();
+  for (size_t j = i + 1; j < leaf->count_; ++j)
+  {
+    new (getSlot(leaf, j - 1)) data_t(std::move(*getSlot(leaf, j)));
+    getSlot(leaf, j)->~data_t();
+  }
+  --leaf->count_;
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::BPlusTree< K, V, C >::leaf_t* ivlicheva::BPlusTree< K, V, C >::findLeaf(const Q& k, bool isUpper) const
+{
+  node_t* node = root_;
+  while (!node->isLeaf_)
+  {
+    const inner_t* inner = static_cast< const inner_t* >(node);
+    size_t first = 0;
+    size_t last = inner->count_;
+    while (first < last)
+    {
+      size_t middle = first + (last - first) / 2;
+      bool isLeft = isUpper ? isLess(k, inner->keys_[middle]) : !isLess(inner->keys_[middle], k);
+      if (isLeft)
+      {
+        last = middle;
+      }
+      else
+      {
+        first = middle + 1;
+      }
+    }
+    node = inner->children_[first];
+  }
+  return static_cast< leaf_t* >(node);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+size_t ivlicheva::BPlusTree< K, V, C >::getLowerIndex(const leaf_t* leaf, const Q& k) const
+{
+  size_t first = 0;
+  size_t last = leaf->count_;
+  while (first < last)
+  {
+    size_t middle = first + (last - first) / 2;
+    if (isLess(getSlot(leaf, middle)->first, k))
+    {
+      first = middle + 1;
+    }
+    else
+    {
+      last = middle;
+    }
+  }
+  return first;
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+size_t ivlicheva::BPlusTree< K, V, C >::getUpperIndex(const leaf_t* leaf, const Q& k) const
+{
+  size_t first = 0;
+  size_t last = leaf->count_;
+  while (first < last)
+  {
+    size_t middle = first + (last - first) / 2;
+    if (isLess(k, getSlot(leaf, middle)->first))
+    {
+      last = middle;
+    }
+    else
+    {
+      first = middle + 1;
+    }
+  }
+  return first;
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::BPlusTree< K, V, C >::getChildIndex(const inner_t* parent, const node_t* child) const
+{
+  size_t i = 0;
+  while (parent->children_[i] != child)
+  {
+    ++i;
+  }
+  return i;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::makeIterator(leaf_t* leaf, size_t i) const
+{
+  if (leaf && i == leaf->count_)
+  {
+    leaf = leaf->next_;
+    i = 0;
+  }
+  return ConstIterator(leaf, leaf ? i : 0, this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::push(const K& k, const V& v)
+{
+  return pushData(data_t(k, v));
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::push(K&& k, V&& v)
+{
+  return pushData(data_t(std::move(k), std::move(v)));
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::pushData(data_t&& data)
+{
+  if (!root_)
+  {
+    first_ = last_ = createLeaf(nullptr);
+    root_ = first_;
+  }
+  leaf_t* leaf = findLeaf(data.first, true);
+  size_t i = getUpperIndex(leaf, data.first);
+  if (leaf->count_ < leafCapacity)
+  {
+    insertAt(leaf, i, std::move(data));
+    ++size_;
+    return ConstIterator(leaf, i, this);
+  }
+  leaf_t* right = createLeaf(leaf->parent_);
+  size_t middle = leafCapacity / 2;
+  for (size_t j = middle; j < leaf->count_; ++j)
+  {
+    new (getSlot(right, j - middle)) data_t(std::move(*getSlot(leaf, j)));
+    getSlot(leaf, j)->~data_t();
+  }
+  right->count_ = leaf->count_ - middle;
+  leaf->count_ = middle;
+  right->prev_ = leaf;
+  right->next_ = leaf->next_;
+  if (leaf->next_)
+  {
+    leaf->next_->prev_ = right;
+  }
+  else
+  {
+    last_ = right;
+  }
+  leaf->next_ = right;
+  leaf_t* target = leaf;
+  if (i > middle)
+  {
+    target = right;
+    i -= middle;
+  }
+  insertAt(target, i, std::move(data));
+  ++size_;
+  insertIntoParent(leaf, getSlot(right, 0)->first, right);
+  return ConstIterator(target, i, this);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::insertIntoParent(node_t* left, const K& k, node_t* right)
+{
+  inner_t* parent = left->parent_;
+  if (!parent)
+  {
+    inner_t* root = createInner(nullptr);
+    root->keys_[0] = k;
+    root->children_[0] = left;
+    root->children_[1] = right;
+    root->count_ = 1;
+    left->parent_ = root;
+    right->parent_ = root;
+    root_ = root;
+    return;
+  }
+  size_t pos = getChildIndex(parent, left);
+  if (parent->count_ < innerCapacity)
+  {
+    for (size_t j = parent->count_; j > pos; --j)
+    {
+      parent->keys_[j] = std::move(parent->keys_[j - 1]);
+      parent->children_[j + 1] = parent->children_[j];
+    }
+    parent->keys_[pos] = k;
+    parent->children_[pos + 1] = right;
+    right->parent_ = parent;
+    ++parent->count_;
+    return;
+  }
+  K keys[innerCapacity + 1];
+  node_t* children[innerCapacity + 2];
+  for (size_t j = 0, from = 0; j <= innerCapacity; ++j)
+  {
+    keys[j] = (j == pos) ? k : std::move(parent->keys_[from++]);
+  }
+  for (size_t j = 0, from = 0; j <= innerCapacity + 1; ++j)
+  {
+    children[j] = (j == pos + 1) ? right : parent->children_[from++];
+  }
+  size_t middle = (innerCapacity + 1) / 2;
+  inner_t* sibling = createInner(parent->parent_);
+  parent->count_ = middle;
+  for (size_t j = 0; j < middle; ++j)
+  {
+    parent->keys_[j] = std::move(keys[j]);
+    parent->children_[j] = children[j];
+    children[j]->parent_ = parent;
+  }
+  parent->children_[middle] = children[middle];
+  children[middle]->parent_ = parent;
+  sibling->count_ = innerCapacity - middle;
+  for (size_t j = 0; j < sibling->count_; ++j)
+  {
+    sibling->keys_[j] = std::move(keys[middle + 1 + j]);
+    sibling->children_[j] = children[middle + 1 + j];
+    sibling->children_[j]->parent_ = sibling;
+  }
+  sibling->children_[sibling->count_] = children[innerCapacity + 1];
+  sibling->children_[sibling->count_]->parent_ = sibling;
+  insertIntoParent(parent, keys[middle], sibling);
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::emplace(const K& k, Args&&... args)
+{
+  return pushData(data_t(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward< Args >(args)...)));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::emplace(K&& k, Args&&... args)
+{
+  return pushData(data_t(std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple(std::forward< Args >(args)...)));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+std::pair< typename ivlicheva::BPlusTree< K, V, C >::Iterator, bool > ivlicheva::BPlusTree< K, V, C >::tryEmplace(const K& k, Args&&... args)
+{
+  Iterator iter = find(k);
+  if (iter != end())
+  {
+    return {iter, false};
+  }
+  return {emplace(k, std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+std::pair< typename ivlicheva::BPlusTree< K, V, C >::Iterator, bool > ivlicheva::BPlusTree< K, V, C >::tryEmplace(K&& k, Args&&... args)
+{
+  Iterator iter = find(k);
+  if (iter != end())
+  {
+    return {iter, false};
+  }
+  return {emplace(std::move(k), std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C >
+template< typename M >
+std::pair< typename ivlicheva::BPlusTree< K, V, C >::Iterator, bool > ivlicheva::BPlusTree< K, V, C >::insertOrAssign(const K& k, M&& obj)
+{
+  Iterator iter = find(k);
+  if (iter == end())
+  {
+    return {emplace(k, std::forward< M >(obj)), true};
+  }
+  iter->second = std::forward< M >(obj);
+  return {iter, false};
+}
+
+template< typename K, typename V, typename C >
+template< typename M >
+std::pair< typename ivlicheva::BPlusTree< K, V, C >::Iterator, bool > ivlicheva::BPlusTree< K, V, C >::insertOrAssign(K&& k, M&& obj)
+{
+  Iterator iter = find(k);
+  if (iter == end())
+  {
+    return {emplace(std::move(k), std::forward< M >(obj)), true};
+  }
+  iter->second = std::forward< M >(obj);
+  return {iter, false};
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::upperBound(const K& k)
+{
+  return const_cast< const this_t& >(*this).upperBound(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::lowerBound(const K& k)
+{
+  return const_cast< const this_t& >(*this).lowerBound(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::find(const K& k)
+{
+  return const_cast< const this_t& >(*this).find(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::upperBound(const K& k) const
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::lowerBound(const K& k) const
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::find(const K& k) const
+{
+  return getEqual(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+void ivlicheva::BPlusTree< K, V, C >::drop(const Q& k)
+{
+  Iterator iter = find(k);
+  if (iter != end())
+  {
+    erase(iter);
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::upperBound(const Q& k)
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::lowerBound(const Q& k)
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::find(const Q& k)
+{
+  return getEqual(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::upperBound(const Q& k) const
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::lowerBound(const Q& k) const
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::find(const Q& k) const
+{
+  return getEqual(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::getFirstNotLess(const Q& k) const
+{
+  if (!root_)
+  {
+    return cend();
+  }
+  leaf_t* leaf = findLeaf(k, false);
+  return makeIterator(leaf, getLowerIndex(leaf, k));
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::getFirstGreater(const Q& k) const
+{
+  if (!root_)
+  {
+    return cend();
+  }
+  leaf_t* leaf = findLeaf(k, true);
+  return makeIterator(leaf, getUpperIndex(leaf, k));
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::getEqual(const Q& k) const
+{
+  ConstIterator iter = getFirstNotLess(k);
+  if (iter != cend() && isLess(k, iter->first))
+  {
+    return cend();
+  }
+  return iter;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::erase(Iterator iter)
+{
+  if (iter == end())
+  {
+    return end();
+  }
+  leaf_t* leaf = iter.citer_.leaf_;
+  removeAt(leaf, iter.citer_.index_);
+  --size_;
+  if (leaf == root_ && leaf->count_ == 0)
+  {
+    destroy();
+    return end();
+  }
+  leaf_t* next = leaf;
+  size_t index = iter.citer_.index_;
+  if (index == leaf->count_)
+  {
+    next = leaf->next_;
+    index = 0;
+  }
+  if (leaf != root_ && leaf->count_ < leafMin)
+  {
+    balanceLeaf(leaf, next, index);
+  }
+  return makeIterator(next, index);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::erase(Iterator first, Iterator last)
+{
+  size_t count = 0;
+  for (Iterator iter = first; iter != last; ++iter)
+  {
+    ++count;
+  }
+  while (count--)
+  {
+    first = erase(first);
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::balanceLeaf(leaf_t* leaf, leaf_t*& next, size_t& index)
+{
+  inner_t* parent = leaf->parent_;
+  size_t pos = getChildIndex(parent, leaf);
+  leaf_t* left = pos > 0 ? static_cast< leaf_t* >(parent->children_[pos - 1]) : nullptr;
+  leaf_t* right = pos < parent->count_ ? static_cast< leaf_t* >(parent->children_[pos + 1]) : nullptr;
+  if (left && left->count_ > leafMin)
+  {
+    insertAt(leaf, 0, std::move(*getSlot(left, left->count_ - 1)));
+    removeAt(left, left->count_ - 1);
+    parent->keys_[pos - 1] = getSlot(leaf, 0)->first;
+    if (next == leaf)
+    {
+      ++index;
+    }
+    return;
+  }
+  if (right && right->count_ > leafMin)
+  {
+    insertAt(leaf, leaf->count_, std::move(*getSlot(right, 0)));
+    removeAt(right, 0);
+    parent->keys_[pos] = getSlot(right, 0)->first;
+    if (next == right && index == 0)
+    {
+      next = leaf;
+      index = leaf->count_ - 1;
+    }
+    else if (next == right)
+    {
+      --index;
+    }
+    return;
+  }
+  if (!left)
+  {
+    left = leaf;
+    leaf = right;
+    ++pos;
+  }
+  if (next == leaf)
+  {
+    next = left;
+    index += left->count_;
+  }
+  for (size_t j = 0; j < leaf->count_; ++j)
+  {
+    new (getSlot(left, left->count_ + j)) data_t(std::move(*getSlot(leaf, j)));
+    getSlot(leaf, j)->~data_t();
+  }
+  left->count_ += leaf->count_;
+  left->next_ = leaf->next_;
+  if (leaf->next_)
+  {
+    leaf->next_->prev_ = left;
+  }
+  else
+  {
+    last_ = left;
+  }
+  removeChild(parent, pos);
+  delete leaf;
+  balanceInner(parent);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::removeChild(inner_t* parent, size_t pos)
+{
+  for (size_t j = pos; j < parent->count_; ++j)
+  {
+    parent->keys_[j - 1] = std::move(parent->keys_[j]);
+    parent->children_[j] = parent->children_[j + 1];
+  }
+  parent->children_[parent->count_] = nullptr;
+  --parent->count_;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::balanceInner(inner_t* inner)
+{
+  if (inner == root_)
+  {
+    if (inner->count_ == 0)
+    {
+      root_ = inner->children_[0];
+      root_->parent_ = nullptr;
+      delete inner;
+    }
+    return;
+  }
+  if (inner->count_ >= innerMin)
+  {
+    return;
+  }
+  inner_t* parent = inner->parent_;
+  size_t pos = getChildIndex(parent, inner);
+  inner_t* left = pos > 0 ? static_cast< inner_t* >(parent->children_[pos - 1]) : nullptr;
+  inner_t* right = pos < parent->count_ ? static_cast< inner_t* >(parent->children_[pos + 1]) : nullptr;
+  if (left && left->count_ > innerMin)
+  {
+    inner->children_[inner->count_ + 1] = inner->children_[inner->count_];
+    for (size_t j = inner->count_; j > 0; --j)
+    {
+      inner->keys_[j] = std::move(inner->keys_[j - 1]);
+      inner->children_[j] = inner->children_[j - 1];
+    }
+    inner->keys_[0] = std::move(parent->keys_[pos - 1]);
+    inner->children_[0] = left->children_[left->count_];
+    inner->children_[0]->parent_ = inner;
+    parent->keys_[pos - 1] = std::move(left->keys_[left->count_ - 1]);
+    left->children_[left->count_] = nullptr;
+    --left->count_;
+    ++inner->count_;
+    return;
+  }
+  if (right && right->count_ > innerMin)
+  {
+    inner->keys_[inner->count_] = std::move(parent->keys_[pos]);
+    inner->children_[inner->count_ + 1] = right->children_[0];
+    inner->children_[inner->count_ + 1]->parent_ = inner;
+    ++inner->count_;
+    parent->keys_[pos] = std::move(right->keys_[0]);
+    for (size_t j = 1; j < right->count_; ++j)
+    {
+      right->keys_[j - 1] = std::move(right->keys_[j]);
+    }
+    for (size_t j = 1; j <= right->count_; ++j)
+    {
+      right->children_[j - 1] = right->children_[j];
+    }
+    right->children_[right->count_] = nullptr;
+    --right->count_;
+    return;
+  }
+  if (!left)
+  {
+    left = inner;
+    inner = right;
+    ++pos;
+  }
+  left->keys_[left->count_] = std::move(parent->keys_[pos - 1]);
+  for (size_t j = 0; j < inner->count_; ++j)
+  {
+    left->keys_[left->count_ + 1 + j] = std::move(inner->keys_[j]);
+  }
+  for (size_t j = 0; j <= inner->count_; ++j)
+  {
+    left->children_[left->count_ + 1 + j] = inner->children_[j];
+    inner->children_[j]->parent_ = left;
+  }
+  left->count_ += inner->count_ + 1;
+  removeChild(parent, pos);
+  delete inner;
+  balanceInner(parent);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::insert(const std::pair< K, V >& p)
+{
+  return push(p.first, p.second);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::insert(std::pair< K, V >&& p)
+{
+  return push(std::move(p.first), std::move(p.second));
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::insert(std::initializer_list< std::pair< K, V > > il)
+{
+  for (auto&& item: il)
+  {
+    insert(item);
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename It >
+void ivlicheva::BPlusTree< K, V, C >::assignSorted(It first, It last)
+{
+  this_t tmp;
+  for (; first != last; ++first)
+  {
+    tmp.pushData(data_t(*first));
+  }
+  swap(tmp);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::BPlusTree< K, V, C >::drop(const K& k)
+{
+  Iterator iter = find(k);
+  if (iter != end())
+  {
+    erase(iter);
+  }
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::BPlusTree< K, V, C >::isEmpty() const noexcept
+{
+  return !root_;
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::BPlusTree< K, V, C >::size() const noexcept
+{
+  return size_;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::begin()
+{
+  return cbegin();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::Iterator ivlicheva::BPlusTree< K, V, C >::end()
+{
+  return cend();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::begin() const
+{
+  return cbegin();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::end() const
+{
+  return cend();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::cbegin() const
+{
+  return ConstIterator(first_, 0, this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::BPlusTree< K, V, C >::ConstIterator ivlicheva::BPlusTree< K, V, C >::cend() const
+{
+  return ConstIterator(nullptr, 0, this);
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::BPlusTree< K, V, C >::traverseLNR(F f) const
+{
+  for (leaf_t* leaf = first_; leaf; leaf = leaf->next_)
+  {
+    for (size_t i = 0; i < leaf->count_; ++i)
+    {
+      f(*getSlot(leaf, i));
+    }
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::BPlusTree< K, V, C >::traverseRNL(F f) const
+{
+  for (leaf_t* leaf = last_; leaf; leaf = leaf->prev_)
+  {
+    for (size_t i = leaf->count_; i > 0; --i)
+    {
+      f(*getSlot(leaf, i - 1));
+    }
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::BPlusTree< K, V, C >::traverseBreadth(F f) const
+{
+  return traverseLNR(f);
+}
+
+template< typename K, typename V, typename C >
+template< typename K1, typename K2 >
+bool ivlicheva::BPlusTree< K, V, C >::isLess(const K1& k1, const K2& k2) const
+{
+  return cmp_(k1, k2);
+}
+
+#endif
@@ -322,8 +322,11 @@ ivlicheva::BidirectionalList< T >::BidirectionalList(std::initializer_list< T >
 template< typename T >
 ivlicheva::BidirectionalList< T >::~BidirectionalList()
 {
-  clear();
-  operator delete(beforeHead_);
+  if (beforeHead_)
+  {
+    clear();
+    operator delete(beforeHead_);
+  }
   beforeHead_ = nullptr;
   tail_ = nullptr;
 }
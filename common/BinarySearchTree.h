@@ -4,27 +4,224 @@
 #include <iterator>
 #include <stdexcept>
 #include <cassert>
-#include "Stack.h"
-#include "Queue.h"
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include "NodePool.h"
+#include "EytzingerIndex.h"
 
 namespace ivlicheva
 {
-  template< typename K, typename V, typename C >
+  namespace detail
+  {
+    template< typename T, bool = std::is_empty< T >::value >
+    struct AugmentHolder
+    {
+      AugmentHolder(const T& value):
+        augment_(value)
+      {}
+      const T& getAugment() const
+      {
+        return augment_;
+      }
+      void setAugment(const T& value)
+      {
+        augment_ = value;
+      }
+
+      T augment_;
+    };
+
+    template< typename T >
+    struct AugmentHolder< T, true >
+    {
+      AugmentHolder(const T&)
+      {}
+      T getAugment() const
+      {
+        return T{};
+      }
+      void setAugment(const T&)
+      {}
+    };
+
+    template< typename C, typename = void >
+    struct HasThreeWay: std::false_type
+    {};
+
+    template< typename C >
+    struct HasThreeWay< C, typename C::three_way >: std::true_type
+    {};
+  }
+
+  struct NoAugmentation
+  {
+    struct value_type
+    {};
+    static constexpr bool isEnabled = false;
+    template< typename Data >
+    static value_type make(const Data&)
+    {
+      return value_type{};
+    }
+    static value_type combine(const value_type&, const value_type&)
+    {
+      return value_type{};
+    }
+    static value_type identity()
+    {
+      return value_type{};
+    }
+  };
+
+  struct OrderStatistic
+  {
+    using value_type = size_t;
+    static constexpr bool isEnabled = true;
+    template< typename Data >
+    static value_type make(const Data&)
+    {
+      return 1;
+    }
+    static value_type combine(const value_type& lhs, const value_type& rhs)
+    {
+      return lhs + rhs;
+    }
+    static value_type identity()
+    {
+      return 0;
+    }
+    static size_t getCount(const value_type& value)
+    {
+      return value;
+    }
+  };
+
+  template< typename M >
+  struct RangeAggregate
+  {
+    struct value_type
+    {
+      size_t count_;
+      typename M::value_type value_;
+    };
+    static constexpr bool isEnabled = true;
+    template< typename Data >
+    static value_type make(const Data& data)
+    {
+      return value_type{1, M::make(data)};
+    }
+    static value_type combine(const value_type& lhs, const value_type& rhs)
+    {
+      return value_type{lhs.count_ + rhs.count_, M::combine(lhs.value_, rhs.value_)};
+    }
+    static value_type identity()
+    {
+      return value_type{0, M::identity()};
+    }
+    static size_t getCount(const value_type& value)
+    {
+      return value.count_;
+    }
+  };
+
+  template< typename T >
+  struct KeySum
+  {
+    using value_type = T;
+    static constexpr bool isEnabled = true;
+    template< typename Data >
+    static value_type make(const Data& data)
+    {
+      return static_cast< T >(data.first);
+    }
+    static value_type combine(const value_type& lhs, const value_type& rhs)
+    {
+      return lhs + rhs;
+    }
+    static value_type identity()
+    {
+      return T();
+    }
+  };
+
+  template< typename T >
+  struct KeyMin
+  {
+    using value_type = T;
+    static constexpr bool isEnabled = true;
+    template< typename Data >
+    static value_type make(const Data& data)
+    {
+      return static_cast< T >(data.first);
+    }
+    static value_type combine(const value_type& lhs, const value_type& rhs)
+    {
+      return rhs < lhs ? rhs : lhs;
+    }
+    static value_type identity()
+    {
+      return std::numeric_limits< T >::max();
+    }
+  };
+
+  template< typename T >
+  struct KeyMax
+  {
+    using value_type = T;
+    static constexpr bool isEnabled = true;
+    template< typename Data >
+    static value_type make(const Data& data)
+    {
+      return static_cast< T >(data.first);
+    }
+    static value_type combine(const value_type& lhs, const value_type& rhs)
+    {
+      return lhs < rhs ? rhs : lhs;
+    }
+    static value_type identity()
+    {
+      return std::numeric_limits< T >::lowest();
+    }
+  };
+
+  struct TreeShape
+  {
+    size_t size_;
+    size_t height_;
+    size_t blackHeight_;
+    size_t maxDepth_;
+    double averageDepth_;
+    size_t leftTurns_;
+    size_t rightTurns_;
+  };
+
+  template< typename K, typename V, typename C, typename A = NoAugmentation >
   class BinarySearchTree
   {
     public:
       class ConstIterator;
       class Iterator;
       using data_t = std::pair< K, V >;
-      struct tree_t
+      using augment_t = typename A::value_type;
+      struct tree_t: detail::AugmentHolder< augment_t >
       {
+        tree_t(const data_t&, tree_t*, tree_t*, uintptr_t, const augment_t& = augment_t());
+        template< typename... Args >
+        tree_t(tree_t*, tree_t*, uintptr_t, Args&&...);
+
         data_t data_;
-        tree_t* parent_;
         tree_t* left_;
         tree_t* right_;
-        char color_;
+        uintptr_t parentAndColor_;
       };
-      using this_t = BinarySearchTree< K, V, C >;
+      using this_t = BinarySearchTree< K, V, C, A >;
 
       BinarySearchTree();
       BinarySearchTree(const this_t&);
@@ -38,16 +235,58 @@ namespace ivlicheva
       void drop(const K&);
       template< typename... Args >
       Iterator emplace(const K&, Args&&...);
+      template< typename... Args >
+      Iterator emplace(K&&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(const K&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(K&&, Args&&...);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(const K&, M&&);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(K&&, M&&);
       Iterator push(const K&, const V&);
+      Iterator push(K&&, V&&);
+      Iterator push(ConstIterator, const K&, const V&);
+      Iterator push(ConstIterator, K&&, V&&);
       Iterator upperBound(const K&);
       Iterator lowerBound(const K&);
+      Iterator find(const K&);
       Iterator erase(Iterator);
       void erase(Iterator, Iterator);
       Iterator insert(const std::pair< K, V >&);
+      Iterator insert(std::pair< K, V >&&);
       void insert(std::initializer_list< std::pair< K, V > >);
+      template< typename It >
+      void assignSorted(It, It);
       ConstIterator upperBound(const K&) const;
       ConstIterator lowerBound(const K&) const;
+      ConstIterator find(const K&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      void drop(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator upperBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator lowerBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator find(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator upperBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator lowerBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator find(const Q&) const;
       bool isEmpty() const noexcept;
+      void freeze();
+      bool isFrozen() const noexcept;
+      TreeShape shapeStats() const;
+      void validate() const;
+
+      size_t size() const;
+      size_t rank(const K&) const;
+      Iterator select(size_t);
+      ConstIterator select(size_t) const;
+      augment_t aggregate(const K&, const K&) const;
 
       Iterator begin();
       Iterator end();
@@ -62,7 +301,17 @@ namespace ivlicheva
       F traverseRNL(F) const;
       template< typename F >
       F traverseBreadth(F) const;
-
+      template< typename T, typename M, typename R >
+      T parallelReduce(M, R, T, size_t = 0) const;
+      // map runs concurrently; f gets the mapped entries one at a time, in key order, on the calling thread
+      template< typename M, typename F >
+      F parallelForEach(M, F, size_t = 0) const;
+      template< typename F >
+      F forEachValue(F);
+      template< typename F >
+      F forEachValue(F) const;
+      template< typename F >
+      void parallelForEachValue(F, size_t = 0);
 
       void print();
       void print(const std::string&, tree_t*, bool);
@@ -70,14 +319,33 @@ namespace ivlicheva
     private:
       tree_t* root_;
       tree_t* nil_;
+      tree_t* min_;
+      tree_t* max_;
+      tree_t* finger_;
+      size_t leftTurns_;
+      size_t rightTurns_;
       C cmp_;
+      detail::NodePool< tree_t > pool_;
+      detail::EytzingerIndex< K, tree_t*, C > frozen_;
 
       void destroy();
       void clear(tree_t*);
+      tree_t* createLeaf(const data_t&, uintptr_t, const augment_t& = augment_t());
+      template< typename... Args >
+      tree_t* emplaceLeaf(Args&&...);
+      Iterator pushLeaf(tree_t*);
+      Iterator pushLeaf(tree_t*, tree_t*);
+      void pushFromRoot(tree_t*);
+      bool pushBetween(tree_t*, tree_t*, tree_t*);
+      void attach(tree_t*, tree_t*, bool);
+      Iterator fixPush(tree_t*);
+      void destroyLeaf(tree_t*);
       void add(tree_t*, tree_t*, tree_t*);
+      tree_t* build(tree_t* const*, size_t, tree_t*, size_t, size_t);
       void drop(tree_t*);
+      void transplant(tree_t*, tree_t*);
       void balancePush(tree_t*);
-      void balanceDrop(tree_t*);
+      void balanceDrop(tree_t*, tree_t*);
       void turnSmallLeft(tree_t*);
       void turnSmallRight(tree_t*);
       void turnSmall(tree_t*);
@@ -85,6 +353,15 @@ namespace ivlicheva
       void turnBigRight(tree_t*);
       void turnBig(tree_t*);
       void colorize(tree_t*, char);
+      char getColor(const tree_t*) const;
+      tree_t* getParent(const tree_t*) const;
+      void setParent(tree_t*, tree_t*);
+      uintptr_t pack(tree_t*, char) const;
+      static tree_t* getSentinel();
+      void updateAugment(tree_t*);
+      void updateAugmentUp(tree_t*);
+      size_t getSize(const tree_t*) const;
+      augment_t getAggregate(const tree_t*) const;
       size_t getHigh(tree_t*) const;
       size_t getBlackHigh(tree_t*) const;
       size_t getDepth(tree_t*) const;
@@ -99,18 +376,64 @@ namespace ivlicheva
       bool isNil(const tree_t*) const;
       bool isRed(const tree_t*) const;
       bool isBlack(const tree_t*) const;
-      bool isLess(const K&, const K&) const;
+      template< typename Q >
+      tree_t* getFirstNotLess(const Q&) const;
+      template< typename Q >
+      tree_t* getFirstGreater(const Q&) const;
+      template< typename Q >
+      tree_t* getEqual(const Q&) const;
+      template< typename Q >
+      tree_t* getEqual(const Q&, std::true_type) const;
+      template< typename Q >
+      tree_t* getEqual(const Q&, std::false_type) const;
+      template< typename K1, typename K2 >
+      bool isLess(const K1&, const K2&) const;
+      template< typename K1, typename K2 >
+      int compare(const K1&, const K2&) const;
+      template< typename K1, typename K2 >
+      int compare(const K1&, const K2&, std::true_type) const;
+      template< typename K1, typename K2 >
+      int compare(const K1&, const K2&, std::false_type) const;
       bool isEqual(const K&, const K&) const;
+      std::vector< tree_t* > getBounds(size_t) const;
+      void collectBounds(tree_t*, size_t, std::vector< tree_t* >&) const;
+      template< typename G >
+      void runTasks(size_t, size_t, G) const;
+  };
+  template< typename K, typename V, typename C, typename A = NoAugmentation >
+  using BST = BinarySearchTree< K, V, C, A >;
+
+  struct RedBlackBackend
+  {
+    template< typename K, typename V, typename C >
+    using tree_t = BinarySearchTree< K, V, C >;
   };
-  template< typename K, typename V, typename C >
-  using BST = BinarySearchTree< K, V, C >;
 }
 
-template< typename K, typename V, typename C >
-class ivlicheva::BinarySearchTree< K, V, C >::ConstIterator: public std::iterator< std::forward_iterator_tag, std::pair< K, V > >
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::tree_t::tree_t(const data_t& data, tree_t* left, tree_t* right, uintptr_t parentAndColor, const augment_t& augment):
+  detail::AugmentHolder< augment_t >(augment),
+  data_(data),
+  left_(left),
+  right_(right),
+  parentAndColor_(parentAndColor)
+{}
+
+template< typename K, typename V, typename C, typename A >
+template< typename... Args >
+ivlicheva::BinarySearchTree< K, V, C, A >::tree_t::tree_t(tree_t* left, tree_t* right, uintptr_t parentAndColor, Args&&... args):
+  detail::AugmentHolder< augment_t >(augment_t()),
+  data_(std::forward< Args >(args)...),
+  left_(left),
+  right_(right),
+  parentAndColor_(parentAndColor)
+{}
+
+template< typename K, typename V, typename C, typename A >
+class ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator: public std::iterator< std::forward_iterator_tag, std::pair< K, V > >
 {
   public:
-    friend class BinarySearchTree< K, V, C >;
+    friend class BinarySearchTree< K, V, C, A >;
     using this_t = ConstIterator;
 
     ConstIterator();
@@ -131,81 +454,81 @@ class ivlicheva::BinarySearchTree< K, V, C >::ConstIterator: public std::iterato
 
   private:
     tree_t* leaf_;
-    const BinarySearchTree< K, V, C >* tree_;
-    ConstIterator(tree_t*, const BinarySearchTree< K, V, C >*);
+    const BinarySearchTree< K, V, C, A >* tree_;
+    ConstIterator(tree_t*, const BinarySearchTree< K, V, C, A >*);
 };
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::ConstIterator():
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::ConstIterator():
   leaf_(nullptr),
   tree_(nullptr)
 {}
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::ConstIterator(tree_t* leaf, const BinarySearchTree< K, V, C >* tree):
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::ConstIterator(tree_t* leaf, const BinarySearchTree< K, V, C, A >* tree):
   leaf_(leaf),
   tree_(tree)
 {}
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator& ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator++()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator& ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator++()
 {
   leaf_ = tree_->getNext(leaf_);
   return *this;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator++(int)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator++(int)
 {
   this_t result(*this);
   ++(*this);
   return result;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator& ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator--()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator& ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator--()
 {
   leaf_ = tree_->getPrev(leaf_);
   return *this;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator--(int)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator--(int)
 {
   this_t result(*this);
   --(*this);
   return result;
 }
 
-template< typename K, typename V, typename C >
-const typename ivlicheva::BinarySearchTree< K, V, C >::data_t& ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator*() const
+template< typename K, typename V, typename C, typename A >
+const typename ivlicheva::BinarySearchTree< K, V, C, A >::data_t& ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator*() const
 {
   return leaf_->data_;
 }
 
-template< typename K, typename V, typename C >
-const typename ivlicheva::BinarySearchTree< K, V, C >::data_t* ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator->() const
+template< typename K, typename V, typename C, typename A >
+const typename ivlicheva::BinarySearchTree< K, V, C, A >::data_t* ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator->() const
 {
   return std::addressof(leaf_->data_);
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator==(const this_t& iter) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator==(const this_t& iter) const
 {
   return leaf_ == iter.leaf_ && tree_ == iter.tree_;
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::ConstIterator::operator!=(const this_t& iter) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator::operator!=(const this_t& iter) const
 {
   return !(*this == iter);
 }
 
-template< typename K, typename V, typename C >
-class ivlicheva::BinarySearchTree< K, V, C >::Iterator: public std::iterator< std::forward_iterator_tag, std::pair< K, V > >
+template< typename K, typename V, typename C, typename A >
+class ivlicheva::BinarySearchTree< K, V, C, A >::Iterator: public std::iterator< std::forward_iterator_tag, std::pair< K, V > >
 {
   public:
-    friend class BinarySearchTree< K, V, C >;
+    friend class BinarySearchTree< K, V, C, A >;
     using this_t = Iterator;
 
     Iterator();
@@ -214,6 +537,7 @@ class ivlicheva::BinarySearchTree< K, V, C >::Iterator: public std::iterator< st
     ~Iterator() = default;
 
     this_t& operator=(const this_t&) = default;
+    operator ConstIterator() const;
     this_t& operator++();
     this_t operator++(int);
     this_t& operator--();
@@ -231,128 +555,137 @@ class ivlicheva::BinarySearchTree< K, V, C >::Iterator: public std::iterator< st
     ConstIterator citer_;
 };
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::Iterator::Iterator():
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::Iterator():
   citer_()
 {}
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::Iterator::Iterator(ConstIterator citer):
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::Iterator(ConstIterator citer):
   citer_(citer)
 {}
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator& ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator++()
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator ConstIterator() const
+{
+  return citer_;
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator& ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator++()
 {
   ++citer_;
   return *this;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator++(int)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator++(int)
 {
   this_t result(*this);
   ++(*this);
   return result;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator& ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator--()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator& ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator--()
 {
   --citer_;
   return *this;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator--(int)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator--(int)
 {
   this_t result(*this);
   --(*this);
   return result;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::data_t& ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator*()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::data_t& ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator*()
 {
   return const_cast< data_t& >(*citer_);
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::data_t* ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator->()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::data_t* ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator->()
 {
   return std::addressof(const_cast< data_t& >(*citer_));
 }
 
-template< typename K, typename V, typename C >
-const typename ivlicheva::BinarySearchTree< K, V, C >::data_t& ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator*() const
+template< typename K, typename V, typename C, typename A >
+const typename ivlicheva::BinarySearchTree< K, V, C, A >::data_t& ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator*() const
 {
   return *citer_;
 }
 
-template< typename K, typename V, typename C >
-const typename ivlicheva::BinarySearchTree< K, V, C >::data_t* ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator->() const
+template< typename K, typename V, typename C, typename A >
+const typename ivlicheva::BinarySearchTree< K, V, C, A >::data_t* ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator->() const
 {
   return std::addressof(*citer_);
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator==(const this_t& iter) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator==(const this_t& iter) const
 {
   return citer_ == iter.citer_;
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::Iterator::operator!=(const this_t& iter) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::Iterator::operator!=(const this_t& iter) const
 {
   return !(*this == iter);
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::begin()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::begin()
 {
   return cbegin();
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::end()
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::end()
 {
   return cend();
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::begin() const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::begin() const
 {
   return cbegin();
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::end() const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::end() const
 {
   return cend();
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::cbegin() const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::cbegin() const
 {
   return ConstIterator(getMin(root_), this);
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::cend() const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::cend() const
 {
   return ConstIterator(nil_, this);
 }
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree():
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::BinarySearchTree():
   root_(nullptr),
-  nil_(static_cast< tree_t* >(operator new(sizeof(tree_t))))
-{
-  colorize(nil_, 'b');
-}
+  nil_(getSentinel()),
+  min_(nullptr),
+  max_(nullptr),
+  finger_(nullptr),
+  leftTurns_(0),
+  rightTurns_(0)
+{}
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree(const this_t& ob):
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::BinarySearchTree(const this_t& ob):
   BinarySearchTree()
 {
   if (!ob.isEmpty())
@@ -360,8 +693,10 @@ ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree(const this_t& ob):
     tree_t* obLeaf = ob.root_;
     try
     {
-      root_ = new tree_t{obLeaf->data_, nullptr, nil_, nil_, obLeaf->color_};
+      root_ = createLeaf(obLeaf->data_, pack(nullptr, ob.getColor(obLeaf)), obLeaf->getAugment());
       add(root_, obLeaf, ob.nil_);
+      min_ = getMin(root_);
+      max_ = getMax(root_);
     }
     catch (...)
     {
@@ -371,34 +706,47 @@ ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree(const this_t& ob):
   }
 }
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::BinarySearchTree(this_t&& ob) noexcept:
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::BinarySearchTree(this_t&& ob) noexcept:
   root_(ob.root_),
-  nil_(ob.nil_)
+  nil_(ob.nil_),
+  min_(ob.min_),
+  max_(ob.max_),
+  finger_(ob.finger_),
+  leftTurns_(ob.leftTurns_),
+  rightTurns_(ob.rightTurns_),
+  pool_(std::move(ob.pool_)),
+  frozen_(std::move(ob.frozen_))
 {
   ob.root_ = nullptr;
-  ob.nil_ = nullptr;
+  ob.min_ = nullptr;
+  ob.max_ = nullptr;
+  ob.finger_ = nullptr;
 }
 
-template< typename K, typename V, typename C >
-ivlicheva::BinarySearchTree< K, V, C >::~BinarySearchTree()
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BinarySearchTree< K, V, C, A >::~BinarySearchTree()
 {
   destroy();
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::destroy()
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::destroy()
 {
-  if (root_)
+  if (root_ && !std::is_trivially_destructible< data_t >::value)
   {
     clear(root_);
-    delete root_;
+    destroyLeaf(root_);
   }
-  operator delete(nil_);
+  root_ = nullptr;
+  min_ = nullptr;
+  max_ = nullptr;
+  finger_ = nullptr;
+  frozen_.clear();
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::clear(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::clear(tree_t* leaf)
 {
   if (leaf && !isNil(leaf))
   {
@@ -406,32 +754,74 @@ void ivlicheva::BinarySearchTree< K, V, C >::clear(tree_t* leaf)
     clear(leaf->right_);
     if (!isNil(leaf->left_))
     {
-      delete leaf->left_;
+      destroyLeaf(leaf->left_);
     }
     if (!isNil(leaf->right_))
     {
-      delete leaf->right_;
+      destroyLeaf(leaf->right_);
     }
   }
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::add(tree_t* newLeaf, tree_t* obLeaf, tree_t* obNil)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::createLeaf(const data_t& data, uintptr_t parentAndColor, const augment_t& augment)
+{
+  tree_t* leaf = pool_.allocate();
+  try
+  {
+    new (leaf) tree_t{data, nil_, nil_, parentAndColor, augment};
+  }
+  catch (...)
+  {
+    pool_.deallocate(leaf);
+    throw;
+  }
+  return leaf;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename... Args >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::emplaceLeaf(Args&&... args)
+{
+  tree_t* leaf = pool_.allocate();
+  try
+  {
+    new (leaf) tree_t(nil_, nil_, pack(nullptr, 'r'), std::forward< Args >(args)...);
+  }
+  catch (...)
+  {
+    pool_.deallocate(leaf);
+    throw;
+  }
+  return leaf;
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::destroyLeaf(tree_t* leaf)
+{
+  leaf->~tree_t();
+  pool_.deallocate(leaf);
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::add(tree_t* newLeaf, tree_t* obLeaf, tree_t* obNil)
 {
   if (obLeaf->left_ != obNil)
   {
-    newLeaf->left_ = new tree_t{obLeaf->left_->data_, newLeaf, nil_, nil_};
-    add(newLeaf->left_, obLeaf->left_, obNil);
+    tree_t* obChild = obLeaf->left_;
+    newLeaf->left_ = createLeaf(obChild->data_, pack(newLeaf, getColor(obChild)), obChild->getAugment());
+    add(newLeaf->left_, obChild, obNil);
   }
   if (obLeaf->right_ != obNil)
   {
-    newLeaf->right_ = new tree_t{obLeaf->right_->data_, newLeaf, nil_, nil_};
-    add(newLeaf->right_, obLeaf->right_, obNil);
+    tree_t* obChild = obLeaf->right_;
+    newLeaf->right_ = createLeaf(obChild->data_, pack(newLeaf, getColor(obChild)), obChild->getAugment());
+    add(newLeaf->right_, obChild, obNil);
   }
 }
 
-template< typename K, typename V, typename C >
-ivlicheva::BST< K, V, C >& ivlicheva::BinarySearchTree< K, V, C >::operator=(const this_t& ob)
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BST< K, V, C, A >& ivlicheva::BinarySearchTree< K, V, C, A >::operator=(const this_t& ob)
 {
   if (this != std::addressof(ob))
   {
@@ -441,8 +831,8 @@ ivlicheva::BST< K, V, C >& ivlicheva::BinarySearchTree< K, V, C >::operator=(con
   return *this;
 }
 
-template< typename K, typename V, typename C >
-ivlicheva::BST< K, V, C >& ivlicheva::BinarySearchTree< K, V, C >::operator=(this_t&& ob) noexcept
+template< typename K, typename V, typename C, typename A >
+ivlicheva::BST< K, V, C, A >& ivlicheva::BinarySearchTree< K, V, C, A >::operator=(this_t&& ob) noexcept
 {
   if (this != std::addressof(ob))
   {
@@ -452,340 +842,247 @@ ivlicheva::BST< K, V, C >& ivlicheva::BinarySearchTree< K, V, C >::operator=(thi
   return *this;
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::swap(this_t& ob) noexcept
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::swap(this_t& ob) noexcept
 {
   std::swap(root_, ob.root_);
   std::swap(nil_, ob.nil_);
+  std::swap(min_, ob.min_);
+  std::swap(max_, ob.max_);
+  std::swap(finger_, ob.finger_);
+  std::swap(leftTurns_, ob.leftTurns_);
+  std::swap(rightTurns_, ob.rightTurns_);
+  pool_.swap(ob.pool_);
+  frozen_.swap(ob.frozen_);
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::balancePush(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::balancePush(tree_t* leaf)
 {
   if (leaf == root_)
   {
+    colorize(leaf, 'b');
     return;
   }
-  if (isRed(leaf->parent_))
+  if (isBlack(getParent(leaf)))
   {
-    if (leaf->parent_ == root_)
-    {
-      colorize(leaf->parent_, 'b');
-      return;
-    }
-    tree_t* uncle = getUncle(leaf);
-    tree_t* parent = leaf->parent_;
-    tree_t* grandParent = leaf->parent_->parent_;
-    if (uncle && isRed(uncle))
-    {
-      colorize(uncle, 'b');
-      colorize(parent, 'b');
-      colorize(grandParent, 'r');
-      balancePush(grandParent);
-    }
-    else if (uncle && isBlack(uncle))
-    {
-      if (isInside(leaf) && isRight(leaf))
-      {
-        turnSmallLeft(leaf);
-        balancePush(leaf);
-      }
-      else if (isInside(leaf) && isLeft(leaf))
-      {
-        turnSmallRight(leaf);
-        balancePush(leaf);
-      }
-      else
-      {
-        colorize(parent, 'b');
-        colorize(grandParent, 'r');
-        if (isRight(parent))
-        {
-          turnSmallLeft(parent);
-        }
-        else
-        {
-          turnSmallRight(parent);
-        }
-      }
-    }
-    else
-    {
-      colorize(parent, 'b');
-      colorize(grandParent, 'r');
-      if (isRight(parent))
-      {
-        turnSmallLeft(parent);
-      }
-      else
-      {
-        turnSmallRight(parent);
-      }
-    }
+    return;
   }
-  else
+  tree_t* parent = getParent(leaf);
+  tree_t* grandParent = getParent(parent);
+  tree_t* uncle = getUncle(leaf);
+  if (isRed(uncle))
   {
-    tree_t* tmp = leaf->parent_;
-    if (getBlackHigh(tmp->left_) > getBlackHigh(tmp->right_))
-    {
-      while (getBlackHigh(tmp->left_) != getBlackHigh(tmp->right_))
-      {
-        tmp = tmp->right_;
-        if (isRed(tmp))
-        {
-          colorize(tmp, 'b');
-        }
-      }
-      return;
-    }
-    if (getBlackHigh(tmp->left_) < getBlackHigh(tmp->right_))
-    {
-      while (getBlackHigh(tmp->left_) != getBlackHigh(tmp->right_))
-      {
-        tmp = tmp->left_;
-        if (isRed(tmp))
-        {
-          colorize(tmp, 'b');
-        }
-      }
-    }
+    colorize(uncle, 'b');
+    colorize(parent, 'b');
+    colorize(grandParent, 'r');
+    balancePush(grandParent);
+    return;
+  }
+  if (isInside(leaf))
+  {
+    turnSmall(leaf);
+    std::swap(leaf, parent);
   }
+  colorize(parent, 'b');
+  colorize(grandParent, 'r');
+  turnSmall(parent);
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::turnBigLeft(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::turnBigLeft(tree_t* leaf)
 {
   turnSmallRight(leaf);
   turnSmallLeft(leaf);
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::turnBigRight(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::turnBigRight(tree_t* leaf)
 {
   turnSmallLeft(leaf);
   turnSmallRight(leaf);
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::turnSmallLeft(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::turnBig(tree_t* leaf)
 {
-  if (!isNil(leaf->left_))
+  turnSmall(leaf);
+  turnSmall(leaf);
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::turnSmall(tree_t* leaf)
+{
+  if (isRight(leaf))
   {
-    leaf->parent_->right_ = leaf->left_;
-    leaf->left_->parent_ = leaf->parent_;
+    turnSmallLeft(leaf);
   }
   else
   {
-    leaf->parent_->right_ = nil_;
+    turnSmallRight(leaf);
   }
-  leaf->left_ = leaf->parent_;
-  if (leaf->parent_->parent_)
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::turnSmallLeft(tree_t* leaf)
+{
+  ++leftTurns_;
+  tree_t* parent = getParent(leaf);
+  tree_t* grandParent = getParent(parent);
+  parent->right_ = leaf->left_;
+  if (!isNil(leaf->left_))
   {
-    tree_t* tmp = leaf->parent_->parent_;
-    leaf->parent_->parent_ = leaf;
-    leaf->parent_ = tmp;
-    if (isLess(leaf->data_.first, tmp->data_.first))
-    {
-      tmp->left_ = leaf;
-    }
-    else
-    {
-      tmp->right_ = leaf;
-    }
+    setParent(leaf->left_, parent);
   }
-  else
+  leaf->left_ = parent;
+  setParent(parent, leaf);
+  setParent(leaf, grandParent);
+  if (!grandParent)
   {
-    leaf->parent_->parent_ = leaf;
-    leaf->parent_ = nullptr;
     root_ = leaf;
   }
+  else if (grandParent->left_ == parent)
+  {
+    grandParent->left_ = leaf;
+  }
+  else
+  {
+    grandParent->right_ = leaf;
+  }
+  updateAugment(parent);
+  updateAugment(leaf);
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::turnSmallRight(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::turnSmallRight(tree_t* leaf)
 {
+  ++rightTurns_;
+  tree_t* parent = getParent(leaf);
+  tree_t* grandParent = getParent(parent);
+  parent->left_ = leaf->right_;
   if (!isNil(leaf->right_))
   {
-    leaf->parent_->left_ = leaf->right_;
-    leaf->right_->parent_ = leaf->parent_;
+    setParent(leaf->right_, parent);
   }
-  else
+  leaf->right_ = parent;
+  setParent(parent, leaf);
+  setParent(leaf, grandParent);
+  if (!grandParent)
   {
-    leaf->parent_->left_ = nil_;
+    root_ = leaf;
   }
-  leaf->right_ = leaf->parent_;
-  if (leaf->parent_->parent_)
+  else if (grandParent->left_ == parent)
   {
-    tree_t* tmp = leaf->parent_->parent_;
-    leaf->parent_->parent_ = leaf;
-    leaf->parent_ = tmp;
-    if (isLess(leaf->data_.first, tmp->data_.first))
-    {
-      tmp->left_ = leaf;
-    }
-    else
-    {
-      tmp->right_ = leaf;
-    }
+    grandParent->left_ = leaf;
   }
   else
   {
-    leaf->parent_->parent_ = leaf;
-    leaf->parent_ = nullptr;
-    root_ = leaf;
+    grandParent->right_ = leaf;
   }
+  updateAugment(parent);
+  updateAugment(leaf);
 }
 
-template< typename K, typename V, typename C >
-size_t ivlicheva::BinarySearchTree< K, V, C >::getDepth(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+size_t ivlicheva::BinarySearchTree< K, V, C, A >::getDepth(tree_t* leaf) const
 {
   size_t depth = 0;
-  while (leaf->parent_)
+  while (getParent(leaf))
   {
-    leaf = leaf->parent_;
+    leaf = getParent(leaf);
     ++depth;
   }
   return depth;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getUncle(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getUncle(tree_t* leaf) const
 {
-  if (isLess(leaf->parent_->data_.first, leaf->parent_->parent_->data_.first))
+  if (isLeft(getParent(leaf)))
   {
-    return leaf->parent_->parent_->right_;
+    return getParent(getParent(leaf))->right_;
   }
-  return leaf->parent_->parent_->left_;
+  return getParent(getParent(leaf))->left_;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getNext(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getNext(tree_t* leaf) const
 {
   if (!leaf || isNil(leaf))
   {
     throw std::logic_error("Bad leaf");
   }
-  if (isNil(leaf->left_) && isNil(leaf->right_))
-  {
-    if (!leaf->parent_)
-    {
-      return nil_;
-    }
-    if (isLeft(leaf))
-    {
-      return leaf->parent_;
-    }
-    if (isRight(leaf))
-    {
-      if (leaf == getMax(root_))
-      {
-        return nil_;
-      }
-      if (leaf->parent_->parent_)
-      {
-        return leaf->parent_->parent_;
-      }
-      return nil_;
-    }
-  }
   if (!isNil(leaf->right_))
   {
     return getMin(leaf->right_);
   }
-  if (isNil(leaf->right_))
+  while (getParent(leaf) && isRight(leaf))
   {
-    if (leaf == getMax(root_))
-    {
-      return nil_;
-    }
-    return leaf->parent_;
+    leaf = getParent(leaf);
+  }
+  if (!getParent(leaf))
+  {
+    return nil_;
   }
-  return nil_;
+  return getParent(leaf);
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getPrev(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getPrev(tree_t* leaf) const
 {
   if (!leaf || isNil(leaf))
   {
     throw std::logic_error("Bad leaf");
   }
-  if (isNil(leaf->left_) && isNil(leaf->right_))
-  {
-    if (!leaf->parent_)
-    {
-      return nil_;
-    }
-    if (isLeft(leaf))
-    {
-      if (leaf == getMin(root_))
-      {
-        return nil_;
-      }
-      if (leaf == getMin(root_->right_))
-      {
-        return root_;
-      }
-      return leaf->parent_->parent_;
-    }
-    if (isRight(leaf))
-    {
-      return leaf->parent_;
-    }
-  }
   if (!isNil(leaf->left_))
   {
     return getMax(leaf->left_);
   }
-  if (isNil(leaf->left_))
+  while (getParent(leaf) && isLeft(leaf))
   {
-    if (leaf == getMin(root_->right_))
-    {
-      return root_;
-    }
-    return leaf->parent_;
+    leaf = getParent(leaf);
+  }
+  if (!getParent(leaf))
+  {
+    return nil_;
   }
-  return nil_;
+  return getParent(leaf);
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isRight(const tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isRight(const tree_t* leaf) const
 {
-  if (!leaf->parent_)
+  if (!getParent(leaf))
   {
     throw std::logic_error("Error");
   }
-  return leaf == leaf->parent_->right_;
+  return leaf == getParent(leaf)->right_;
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isLeft(const tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isLeft(const tree_t* leaf) const
 {
   return !isRight(leaf);
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isInside(const tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isInside(const tree_t* leaf) const
 {
-  if (isLess(leaf->parent_->data_.first, leaf->parent_->parent_->data_.first))
-  {
-    return !isLess(leaf->data_.first, leaf->parent_->data_.first);
-  }
-  return isLess(leaf->data_.first, leaf->parent_->data_.first);
+  return isLeft(leaf) != isLeft(getParent(leaf));
 }
 
-template< typename K, typename V, typename C >
-size_t ivlicheva::BinarySearchTree< K, V, C >::getBlackHigh(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+size_t ivlicheva::BinarySearchTree< K, V, C, A >::getBlackHigh(tree_t* leaf) const
 {
   if (!leaf || isNil(leaf))
   {
     return 0;
   }
-  return std::max(getBlackHigh(leaf->left_), getBlackHigh(leaf->right_)) + (leaf->color_ == 'b' ? 1 : 0);
+  return std::max(getBlackHigh(leaf->left_), getBlackHigh(leaf->right_)) + (isBlack(leaf) ? 1 : 0);
 }
 
-template< typename K, typename V, typename C >
-size_t ivlicheva::BinarySearchTree< K, V, C >::getHigh(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+size_t ivlicheva::BinarySearchTree< K, V, C, A >::getHigh(tree_t* leaf) const
 {
   if (isNil(leaf))
   {
@@ -794,549 +1091,1355 @@ size_t ivlicheva::BinarySearchTree< K, V, C >::getHigh(tree_t* leaf) const
   return std::max(getHigh(leaf->left_), getHigh(leaf->right_)) + 1;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::push(const K& k, const V& v)
-{
-  tree_t* leaf = new tree_t{{k, v}, nullptr, nil_, nil_, 'r'};
-  if (!root_)
-  {
-    root_ = leaf;
-    return ConstIterator(leaf, this);
-  }
-  tree_t* tmp = root_;
-  while (!isNil(tmp))
-  {
-    if (isLess(k, tmp->data_.first))
-    {
-      if (isNil(tmp->left_))
-      {
-        leaf->parent_ = tmp;
-        tmp->left_ = leaf;
-        balancePush(leaf);
-        break;
-      }
-      tmp = tmp->left_;
-    }
-    if (!isLess(k, tmp->data_.first))
-    {
-      if (isNil(tmp->right_))
-      {
-        leaf->parent_ = tmp;
-        tmp->right_ = leaf;
-        balancePush(leaf);
-        break;
-      }
-      tmp = tmp->right_;
-    }
-  }
-  return ConstIterator(leaf, this);
-}
-
-template< typename K, typename V, typename C >
-template< typename... Args >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::emplace(const K& k, Args&&... args)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::push(const K& k, const V& v)
 {
-  return push(k, V(std::forward< Args >(args)...));
+  return pushLeaf(emplaceLeaf(k, v));
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::upperBound(const K& k)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::push(K&& k, V&& v)
 {
-  return const_cast< const this_t& >(*this).upperBound(k);
+  return pushLeaf(emplaceLeaf(std::move(k), std::move(v)));
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::lowerBound(const K& k)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::push(ConstIterator hint, const K& k, const V& v)
 {
-  return const_cast< const this_t& >(*this).lowerBound(k);
+  return pushLeaf(emplaceLeaf(k, v), hint.leaf_);
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::upperBound(const K& k) const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::push(ConstIterator hint, K&& k, V&& v)
 {
-  ConstIterator iter = begin();
-  while (iter != end() && isLess(iter.leaf_->data_.first, k))
-  {
-    ++iter;
-  }
-  return iter;
+  return pushLeaf(emplaceLeaf(std::move(k), std::move(v)), hint.leaf_);
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::ConstIterator ivlicheva::BinarySearchTree< K, V, C >::lowerBound(const K& k) const
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::pushLeaf(tree_t* leaf)
 {
-  ConstIterator iter = begin();
-  while (iter != end() && !isLess(k, iter.leaf_->data_.first))
+  if (finger_)
   {
-    ++iter;
+    tree_t* prev = finger_;
+    tree_t* next = finger_;
+    if (isLess(leaf->data_.first, finger_->data_.first))
+    {
+      prev = (finger_ == min_) ? nil_ : getPrev(finger_);
+    }
+    else
+    {
+      next = (finger_ == max_) ? nil_ : getNext(finger_);
+    }
+    if (pushBetween(leaf, prev, next))
+    {
+      return fixPush(leaf);
+    }
+  }
+  pushFromRoot(leaf);
+  return fixPush(leaf);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::pushLeaf(tree_t* leaf, tree_t* next)
+{
+  if (root_ && next)
+  {
+    tree_t* prev = nil_;
+    if (isNil(next))
+    {
+      prev = max_;
+    }
+    else if (next != min_)
+    {
+      prev = getPrev(next);
+    }
+    if (pushBetween(leaf, prev, next))
+    {
+      return fixPush(leaf);
+    }
+  }
+  pushFromRoot(leaf);
+  return fixPush(leaf);
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::pushFromRoot(tree_t* leaf)
+{
+  const K& k = leaf->data_.first;
+  tree_t* tmp = root_;
+  tree_t* parent = nullptr;
+  bool isLeftChild = false;
+  while (tmp && !isNil(tmp))
+  {
+    parent = tmp;
+    isLeftChild = isLess(k, tmp->data_.first);
+    tmp = isLeftChild ? tmp->left_ : tmp->right_;
+  }
+  attach(leaf, parent, isLeftChild);
+}
+
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::pushBetween(tree_t* leaf, tree_t* prev, tree_t* next)
+{
+  const K& k = leaf->data_.first;
+  if ((!isNil(prev) && isLess(k, prev->data_.first)) || (!isNil(next) && !isLess(k, next->data_.first)))
+  {
+    return false;
+  }
+  if (!isNil(prev) && isNil(prev->right_))
+  {
+    attach(leaf, prev, false);
+  }
+  else
+  {
+    attach(leaf, next, true);
+  }
+  return true;
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::attach(tree_t* leaf, tree_t* parent, bool isLeftChild)
+{
+  setParent(leaf, parent);
+  if (!parent)
+  {
+    root_ = leaf;
+    min_ = leaf;
+    max_ = leaf;
+  }
+  else if (isLeftChild)
+  {
+    parent->left_ = leaf;
+    min_ = (parent == min_) ? leaf : min_;
+  }
+  else
+  {
+    parent->right_ = leaf;
+    max_ = (parent == max_) ? leaf : max_;
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::fixPush(tree_t* leaf)
+{
+  updateAugment(leaf);
+  updateAugmentUp(getParent(leaf));
+  balancePush(leaf);
+  finger_ = leaf;
+  frozen_.clear();
+  return ConstIterator(leaf, this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename... Args >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::emplace(const K& k, Args&&... args)
+{
+  return pushLeaf(emplaceLeaf(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward< Args >(args)...)));
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename... Args >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::emplace(K&& k, Args&&... args)
+{
+  return pushLeaf(emplaceLeaf(std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple(std::forward< Args >(args)...)));
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename... Args >
+std::pair< typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator, bool > ivlicheva::BinarySearchTree< K, V, C, A >::tryEmplace(const K& k, Args&&... args)
+{
+  tree_t* leaf = getEqual(k);
+  if (!isNil(leaf))
+  {
+    return {ConstIterator(leaf, this), false};
+  }
+  return {emplace(k, std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename... Args >
+std::pair< typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator, bool > ivlicheva::BinarySearchTree< K, V, C, A >::tryEmplace(K&& k, Args&&... args)
+{
+  tree_t* leaf = getEqual(k);
+  if (!isNil(leaf))
+  {
+    return {ConstIterator(leaf, this), false};
   }
+  return {emplace(std::move(k), std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename M >
+std::pair< typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator, bool > ivlicheva::BinarySearchTree< K, V, C, A >::insertOrAssign(const K& k, M&& obj)
+{
+  tree_t* leaf = getEqual(k);
+  if (isNil(leaf))
+  {
+    return {emplace(k, std::forward< M >(obj)), true};
+  }
+  leaf->data_.second = std::forward< M >(obj);
+  updateAugment(leaf);
+  updateAugmentUp(getParent(leaf));
+  return {ConstIterator(leaf, this), false};
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename M >
+std::pair< typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator, bool > ivlicheva::BinarySearchTree< K, V, C, A >::insertOrAssign(K&& k, M&& obj)
+{
+  tree_t* leaf = getEqual(k);
+  if (isNil(leaf))
+  {
+    return {emplace(std::move(k), std::forward< M >(obj)), true};
+  }
+  leaf->data_.second = std::forward< M >(obj);
+  updateAugment(leaf);
+  updateAugmentUp(getParent(leaf));
+  return {ConstIterator(leaf, this), false};
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::upperBound(const K& k)
+{
+  return const_cast< const this_t& >(*this).upperBound(k);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::lowerBound(const K& k)
+{
+  return const_cast< const this_t& >(*this).lowerBound(k);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::upperBound(const K& k) const
+{
+  return ConstIterator(getFirstNotLess(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::lowerBound(const K& k) const
+{
+  return ConstIterator(getFirstGreater(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::find(const K& k)
+{
+  return const_cast< const this_t& >(*this).find(k);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::find(const K& k) const
+{
+  return ConstIterator(getEqual(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+void ivlicheva::BinarySearchTree< K, V, C, A >::drop(const Q& k)
+{
+  tree_t* leaf = getEqual(k);
+  if (!isNil(leaf))
+  {
+    drop(leaf);
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::upperBound(const Q& k)
+{
+  return ConstIterator(getFirstNotLess(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::lowerBound(const Q& k)
+{
+  return ConstIterator(getFirstGreater(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::find(const Q& k)
+{
+  return ConstIterator(getEqual(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::upperBound(const Q& k) const
+{
+  return ConstIterator(getFirstNotLess(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::lowerBound(const Q& k) const
+{
+  return ConstIterator(getFirstGreater(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q, typename D, typename >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::find(const Q& k) const
+{
+  return ConstIterator(getEqual(k), this);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getFirstNotLess(const Q& k) const
+{
+  if (frozen_.isBuilt())
+  {
+    size_t i = frozen_.getFirstNotLess(k);
+    return i ? frozen_.getValue(i) : nil_;
+  }
+  tree_t* result = nil_;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
+  {
+    if (isLess(tmp->data_.first, k))
+    {
+      tmp = tmp->right_;
+    }
+    else
+    {
+      result = tmp;
+      tmp = tmp->left_;
+    }
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getFirstGreater(const Q& k) const
+{
+  if (frozen_.isBuilt())
+  {
+    size_t i = frozen_.getFirstGreater(k);
+    return i ? frozen_.getValue(i) : nil_;
+  }
+  tree_t* result = nil_;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
+  {
+    if (isLess(k, tmp->data_.first))
+    {
+      result = tmp;
+      tmp = tmp->left_;
+    }
+    else
+    {
+      tmp = tmp->right_;
+    }
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getEqual(const Q& k) const
+{
+  return getEqual(k, detail::HasThreeWay< C >());
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getEqual(const Q& k, std::true_type) const
+{
+  if (frozen_.isBuilt())
+  {
+    return getEqual(k, std::false_type());
+  }
+  tree_t* result = nil_;
+  bool isFound = false;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
+  {
+    int order = compare(tmp->data_.first, k);
+    if (order < 0)
+    {
+      tmp = tmp->right_;
+    }
+    else
+    {
+      result = tmp;
+      isFound = !order;
+      tmp = tmp->left_;
+    }
+  }
+  return isFound ? result : nil_;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename Q >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getEqual(const Q& k, std::false_type) const
+{
+  tree_t* result = getFirstNotLess(k);
+  if (!isNil(result) && isLess(k, result->data_.first))
+  {
+    return nil_;
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::erase(Iterator iter)
+{
+  if (iter == end())
+  {
+    return end();
+  }
+  tree_t* leaf = iter.citer_.leaf_;
+  ++iter;
+  drop(leaf);
   return iter;
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::erase(Iterator iter)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::erase(Iterator first, Iterator last)
+{
+  if (first == begin() && last == end())
+  {
+    destroy();
+    pool_ = detail::NodePool< tree_t >();
+    return;
+  }
+  while (first != last)
+  {
+    first = erase(first);
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::insert(const std::pair< K, V >& p)
+{
+  return push(p.first, p.second);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::insert(std::pair< K, V >&& p)
+{
+  return push(std::move(p.first), std::move(p.second));
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::insert(std::initializer_list< std::pair< K, V > > il)
+{
+  for (auto&& item: il)
+  {
+    insert(item);
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename It >
+void ivlicheva::BinarySearchTree< K, V, C, A >::assignSorted(It first, It last)
+{
+  this_t tmp;
+  std::vector< tree_t* > leaves;
+  leaves.reserve(std::distance(first, last));
+  try
+  {
+    for (; first != last; ++first)
+    {
+      leaves.push_back(tmp.emplaceLeaf(*first));
+    }
+  }
+  catch (...)
+  {
+    for (tree_t* leaf: leaves)
+    {
+      tmp.destroyLeaf(leaf);
+    }
+    throw;
+  }
+  size_t redDepth = 0;
+  while ((static_cast< size_t >(2) << redDepth) <= leaves.size() + 1)
+  {
+    ++redDepth;
+  }
+  if (!leaves.empty())
+  {
+    tmp.root_ = tmp.build(leaves.data(), leaves.size(), nullptr, 0, redDepth);
+    tmp.min_ = leaves.front();
+    tmp.max_ = leaves.back();
+  }
+  swap(tmp);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::build(tree_t* const* leaves, size_t count, tree_t* parent, size_t depth, size_t redDepth)
+{
+  if (!count)
+  {
+    return nil_;
+  }
+  size_t middle = count / 2;
+  tree_t* leaf = leaves[middle];
+  leaf->parentAndColor_ = pack(parent, depth == redDepth ? 'r' : 'b');
+  leaf->left_ = build(leaves, middle, leaf, depth + 1, redDepth);
+  leaf->right_ = build(leaves + middle + 1, count - middle - 1, leaf, depth + 1, redDepth);
+  updateAugment(leaf);
+  return leaf;
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::drop(const K& k)
+{
+  tree_t* leaf = getEqual(k);
+  if (!isNil(leaf))
+  {
+    drop(leaf);
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::balanceDrop(tree_t* leaf, tree_t* parent)
+{
+  if (!parent || isRed(leaf))
+  {
+    if (!isNil(leaf))
+    {
+      colorize(leaf, 'b');
+    }
+    return;
+  }
+  if (leaf == parent->left_)
+  {
+    tree_t* brother = parent->right_;
+    if (isRed(brother))
+    {
+      colorize(brother, 'b');
+      colorize(parent, 'r');
+      turnSmallLeft(brother);
+      brother = parent->right_;
+    }
+    if (isBlack(brother->left_) && isBlack(brother->right_))
+    {
+      colorize(brother, 'r');
+      balanceDrop(parent, getParent(parent));
+      return;
+    }
+    if (isBlack(brother->right_))
+    {
+      colorize(brother->left_, 'b');
+      colorize(brother, 'r');
+      turnSmallRight(brother->left_);
+      brother = parent->right_;
+    }
+    colorize(brother, getColor(parent));
+    colorize(parent, 'b');
+    colorize(brother->right_, 'b');
+    turnSmallLeft(brother);
+  }
+  else
+  {
+    tree_t* brother = parent->left_;
+    if (isRed(brother))
+    {
+      colorize(brother, 'b');
+      colorize(parent, 'r');
+      turnSmallRight(brother);
+      brother = parent->left_;
+    }
+    if (isBlack(brother->left_) && isBlack(brother->right_))
+    {
+      colorize(brother, 'r');
+      balanceDrop(parent, getParent(parent));
+      return;
+    }
+    if (isBlack(brother->left_))
+    {
+      colorize(brother->right_, 'b');
+      colorize(brother, 'r');
+      turnSmallLeft(brother->right_);
+      brother = parent->left_;
+    }
+    colorize(brother, getColor(parent));
+    colorize(parent, 'b');
+    colorize(brother->left_, 'b');
+    turnSmallRight(brother);
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::drop(tree_t* leaf)
+{
+  if (leaf == min_)
+  {
+    min_ = getNext(leaf);
+    min_ = isNil(min_) ? nullptr : min_;
+  }
+  if (leaf == max_)
+  {
+    max_ = getPrev(leaf);
+    max_ = isNil(max_) ? nullptr : max_;
+  }
+  if (leaf == finger_)
+  {
+    finger_ = nullptr;
+  }
+  frozen_.clear();
+  tree_t* child = nil_;
+  tree_t* parent = nullptr;
+  char color = getColor(leaf);
+  if (isNil(leaf->left_) || isNil(leaf->right_))
+  {
+    child = isNil(leaf->left_) ? leaf->right_ : leaf->left_;
+    parent = getParent(leaf);
+    transplant(leaf, child);
+  }
+  else
+  {
+    tree_t* next = getMin(leaf->right_);
+    color = getColor(next);
+    child = next->right_;
+    parent = next;
+    if (getParent(next) != leaf)
+    {
+      parent = getParent(next);
+      transplant(next, child);
+      next->right_ = leaf->right_;
+      setParent(next->right_, next);
+    }
+    transplant(leaf, next);
+    next->left_ = leaf->left_;
+    setParent(next->left_, next);
+    colorize(next, getColor(leaf));
+  }
+  updateAugmentUp(parent);
+  if (color == 'b')
+  {
+    balanceDrop(child, parent);
+  }
+  destroyLeaf(leaf);
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::transplant(tree_t* leaf, tree_t* child)
+{
+  tree_t* parent = getParent(leaf);
+  if (!parent)
+  {
+    root_ = isNil(child) ? nullptr : child;
+  }
+  else if (parent->left_ == leaf)
+  {
+    parent->left_ = child;
+  }
+  else
+  {
+    parent->right_ = child;
+  }
+  if (!isNil(child))
+  {
+    setParent(child, parent);
+  }
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getMax(tree_t* leaf) const
+{
+  if (!leaf)
+  {
+    return nil_;
+  }
+  while (!isNil(leaf->right_))
+  {
+    leaf = leaf->right_;
+  }
+  return leaf;
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getMin(tree_t* leaf) const
+{
+  if (!leaf)
+  {
+    return nil_;
+  }
+  while (!isNil(leaf->left_))
+  {
+    leaf = leaf->left_;
+  }
+  return leaf;
+}
+
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isNil(const tree_t* leaf) const
+{
+  return leaf == nil_;
+}
+
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isRed(const tree_t* leaf) const
+{
+  return getColor(leaf) == 'r';
+}
+
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isBlack(const tree_t* leaf) const
+{
+  return getColor(leaf) == 'b';
+}
+
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isEmpty() const noexcept
+{
+  return !root_;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename F >
+F ivlicheva::BinarySearchTree< K, V, C, A >::traverseLNR(F f) const
+{
+  if (!root_)
+  {
+    return f;
+  }
+  for (tree_t* leaf = getMin(root_); !isNil(leaf); leaf = getNext(leaf))
+  {
+    f(leaf->data_);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename F >
+F ivlicheva::BinarySearchTree< K, V, C, A >::traverseRNL(F f) const
+{
+  if (!root_)
+  {
+    return f;
+  }
+  for (tree_t* leaf = getMax(root_); !isNil(leaf); leaf = getPrev(leaf))
+  {
+    f(leaf->data_);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename F >
+F ivlicheva::BinarySearchTree< K, V, C, A >::traverseBreadth(F f) const
+{
+  if (!root_)
+  {
+    return f;
+  }
+  size_t black = 0;
+  for (tree_t* leaf = root_; !isNil(leaf); leaf = leaf->left_)
+  {
+    black += isBlack(leaf) ? 1 : 0;
+  }
+  bool isDeeper = true;
+  for (size_t level = 0; isDeeper; ++level)
+  {
+    isDeeper = false;
+    tree_t* leaf = root_;
+    tree_t* from = nullptr;
+    size_t depth = 0;
+    size_t height = black;
+    while (leaf)
+    {
+      tree_t* next = getParent(leaf);
+      size_t below = height - (isBlack(leaf) ? 1 : 0);
+      bool isReachable = depth + 1 + 2 * below >= level;
+      if (from == getParent(leaf) && depth == level)
+      {
+        f(leaf->data_);
+        isDeeper = isDeeper || !isNil(leaf->left_) || !isNil(leaf->right_);
+      }
+      else if (from == getParent(leaf) && isReachable && !isNil(leaf->left_))
+      {
+        next = leaf->left_;
+      }
+      else if (from != leaf->right_ && isReachable && !isNil(leaf->right_))
+      {
+        next = leaf->right_;
+      }
+      from = leaf;
+      if (next == getParent(leaf))
+      {
+        --depth;
+        height += (next && isBlack(next)) ? 1 : 0;
+      }
+      else
+      {
+        ++depth;
+        height = below;
+      }
+      leaf = next;
+    }
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::colorize(tree_t* leaf, char c)
+{
+  assert(c == 'b' || c == 'r');
+  leaf->parentAndColor_ = pack(getParent(leaf), c);
+}
+
+template< typename K, typename V, typename C, typename A >
+char ivlicheva::BinarySearchTree< K, V, C, A >::getColor(const tree_t* leaf) const
+{
+  return (leaf->parentAndColor_ & 1) ? 'r' : 'b';
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getParent(const tree_t* leaf) const
 {
-  if (iter == end())
+  return reinterpret_cast< tree_t* >(leaf->parentAndColor_ & ~static_cast< uintptr_t >(1));
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::setParent(tree_t* leaf, tree_t* parent)
+{
+  leaf->parentAndColor_ = pack(parent, getColor(leaf));
+}
+
+template< typename K, typename V, typename C, typename A >
+uintptr_t ivlicheva::BinarySearchTree< K, V, C, A >::pack(tree_t* parent, char c) const
+{
+  return reinterpret_cast< uintptr_t >(parent) | (c == 'r' ? 1 : 0);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* ivlicheva::BinarySearchTree< K, V, C, A >::getSentinel()
+{
+  static typename std::aligned_storage< sizeof(tree_t), alignof(tree_t) >::type sentinel;
+  return reinterpret_cast< tree_t* >(std::addressof(sentinel));
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::updateAugment(tree_t* leaf)
+{
+  if (!A::isEnabled)
   {
-    return end();
+    return;
+  }
+  typename A::value_type value = A::make(leaf->data_);
+  if (!isNil(leaf->left_))
+  {
+    value = A::combine(leaf->left_->getAugment(), value);
+  }
+  if (!isNil(leaf->right_))
+  {
+    value = A::combine(value, leaf->right_->getAugment());
   }
-  Iterator iter2 = iter;
-  ++iter2;
-  drop(iter->first);
-  return iter2;
+  leaf->setAugment(value);
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::erase(Iterator first, Iterator last)
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::updateAugmentUp(tree_t* leaf)
 {
-  while (first != last)
+  if (!A::isEnabled)
   {
-    first = erase(first);
+    return;
+  }
+  while (leaf)
+  {
+    updateAugment(leaf);
+    leaf = getParent(leaf);
   }
 }
 
-template< typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::Iterator ivlicheva::BinarySearchTree< K, V, C >::insert(const std::pair< K, V >& p)
+template< typename K, typename V, typename C, typename A >
+size_t ivlicheva::BinarySearchTree< K, V, C, A >::getSize(const tree_t* leaf) const
 {
-  return push(p.first, p.second);
+  if (!leaf || isNil(leaf))
+  {
+    return 0;
+  }
+  return A::getCount(leaf->getAugment());
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::insert(std::initializer_list< std::pair< K, V > > il)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::augment_t ivlicheva::BinarySearchTree< K, V, C, A >::getAggregate(const tree_t* leaf) const
 {
-  for (auto&& item: il)
+  if (!leaf || isNil(leaf))
   {
-    insert(item);
+    return A::identity();
   }
+  return leaf->getAugment();
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::drop(const K& k)
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::augment_t ivlicheva::BinarySearchTree< K, V, C, A >::aggregate(const K& lo, const K& hi) const
 {
-  if (isEqual(k, root_->data_.first))
+  static_assert(A::isEnabled, "aggregate requires an augmentation policy");
+  tree_t* split = root_;
+  while (split && !isNil(split))
   {
-    drop(root_);
-    return;
+    if (isLess(split->data_.first, lo))
+    {
+      split = split->right_;
+    }
+    else if (isLess(hi, split->data_.first))
+    {
+      split = split->left_;
+    }
+    else
+    {
+      break;
+    }
   }
-  tree_t* tmp = root_;
-  while (tmp)
+  if (!split || isNil(split))
   {
-    if (isLess(k, tmp->data_.first))
+    return A::identity();
+  }
+  augment_t left = A::identity();
+  for (tree_t* tmp = split->left_; !isNil(tmp);)
+  {
+    if (isLess(tmp->data_.first, lo))
+    {
+      tmp = tmp->right_;
+    }
+    else
+    {
+      left = A::combine(A::combine(A::make(tmp->data_), getAggregate(tmp->right_)), left);
+      tmp = tmp->left_;
+    }
+  }
+  augment_t right = A::identity();
+  for (tree_t* tmp = split->right_; !isNil(tmp);)
+  {
+    if (isLess(hi, tmp->data_.first))
     {
       tmp = tmp->left_;
-      if (tmp->data_.first == k)
-      {
-        drop(tmp);
-        break;
-      }
     }
-    if (!isLess(k, tmp->data_.first))
+    else
     {
+      right = A::combine(right, A::combine(getAggregate(tmp->left_), A::make(tmp->data_)));
       tmp = tmp->right_;
-      if (tmp->data_.first == k)
-      {
-        drop(tmp);
-        break;
-      }
     }
   }
+  return A::combine(A::combine(left, A::make(split->data_)), right);
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::freeze()
+{
+  std::vector< tree_t* > leaves;
+  for (tree_t* leaf = min_; leaf && !isNil(leaf); leaf = getNext(leaf))
+  {
+    leaves.push_back(leaf);
+  }
+  frozen_.assign(leaves, [](const tree_t* leaf) -> const K&
+   {
+     return leaf->data_.first;
+   });
+}
+
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isFrozen() const noexcept
+{
+  return frozen_.isBuilt();
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::balanceDrop(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+ivlicheva::TreeShape ivlicheva::BinarySearchTree< K, V, C, A >::shapeStats() const
 {
-  if (isRed(leaf))
+  TreeShape result{0, 0, 0, 0, 0.0, leftTurns_, rightTurns_};
+  size_t totalDepth = 0;
+  size_t depth = 0;
+  tree_t* leaf = root_;
+  tree_t* from = nullptr;
+  while (leaf)
   {
-    if (getBlackHigh(leaf->left_) > getBlackHigh(leaf->right_) && isBlack(leaf->left_))
+    tree_t* next = getParent(leaf);
+    if (from == getParent(leaf))
     {
-      if (isBlack(leaf->left_->left_) && isBlack(leaf->left_->right_))
+      ++result.size_;
+      totalDepth += depth;
+      result.maxDepth_ = std::max(result.maxDepth_, depth);
+      if (!isNil(leaf->left_))
       {
-        std::swap(leaf->color_, leaf->left_->color_);
+        next = leaf->left_;
       }
-      else if (isRed(leaf->left_->left_))
+      else if (!isNil(leaf->right_))
       {
-        std::swap(leaf->color_, leaf->left_->color_);
-        colorize(leaf->left_->left_, 'b');
-        turnSmallRight(leaf->left_);
+        next = leaf->right_;
       }
     }
-    else if (getBlackHigh(leaf->left_) < getBlackHigh(leaf->right_) && isBlack(leaf->right_))
+    else if (from == leaf->left_ && !isNil(leaf->right_))
     {
-      if (isBlack(leaf->right_->left_) && isBlack(leaf->right_->right_))
-      {
-        std::swap(leaf->color_, leaf->right_->color_);
-      }
-      else if (isRed(leaf->right_->right_))
-      {
-        std::swap(leaf->color_, leaf->right_->color_);
-        colorize(leaf->right_->right_, 'b');
-        turnSmallLeft(leaf->right_);
-      }
+      next = leaf->right_;
+    }
+    from = leaf;
+    depth = next == getParent(leaf) ? depth - 1 : depth + 1;
+    leaf = next;
+  }
+  if (result.size_)
+  {
+    result.height_ = result.maxDepth_ + 1;
+    result.blackHeight_ = getBlackHigh(root_);
+    result.averageDepth_ = static_cast< double >(totalDepth) / static_cast< double >(result.size_);
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::validate() const
+{
+  if (!root_)
+  {
+    if (min_ || max_)
+    {
+      throw std::logic_error("Bad bounds");
     }
+    return;
+  }
+  if (getParent(root_) || isRed(root_))
+  {
+    throw std::logic_error("Bad root");
+  }
+  if (min_ != getMin(root_) || max_ != getMax(root_))
+  {
+    throw std::logic_error("Bad bounds");
   }
-  else if (isBlack(leaf))
+  size_t blackHeight = 0;
+  size_t black = 0;
+  tree_t* leaf = root_;
+  tree_t* from = nullptr;
+  tree_t* prev = nullptr;
+  while (leaf)
   {
-    if (getBlackHigh(leaf->left_) > getBlackHigh(leaf->right_))
+    tree_t* next = getParent(leaf);
+    if ((from == getParent(leaf) && isNil(leaf->left_)) || from == leaf->left_)
     {
-      if (isRed(leaf->left_))
-      {
-        if (isBlack(leaf->left_->right_->left_) && isBlack(leaf->left_->right_->right_))
-        {
-          std::swap(leaf->left_->color_, leaf->left_->right_->color_);
-          turnSmallRight(leaf->left_);
-        }
-        else if (isRed(leaf->left_->right_->left_))
-        {
-          colorize(leaf->left_->right_->left_, 'b');
-          turnBigRight(leaf->left_->right_);
-        }
-      }
-      else
+      if (prev && isLess(leaf->data_.first, prev->data_.first))
       {
-        if (isRed(leaf->left_->right_))
-        {
-          colorize(leaf->left_->right_, 'b');
-          turnBigRight(leaf->left_->right_);
-        }
-        else if (isBlack(leaf->left_->right_) && isBlack(leaf->left_->left_))
-        {
-          colorize(leaf->left_, 'r');
-          if (leaf->parent_)
-          {
-            balanceDrop(leaf->parent_);
-          }
-        }
+        throw std::logic_error("Bad order");
       }
+      prev = leaf;
     }
-    else if (getBlackHigh(leaf->left_) < getBlackHigh(leaf->right_))
+    if (from == getParent(leaf))
     {
-      if (isRed(leaf->right_))
+      black += isBlack(leaf) ? 1 : 0;
+      for (tree_t* child: {leaf->left_, leaf->right_})
       {
-        if (isBlack(leaf->right_->left_->left_) && isBlack(leaf->right_->left_->right_))
+        if (isNil(child))
         {
-          std::swap(leaf->right_->color_, leaf->right_->left_->color_);
-          turnSmallLeft(leaf->right_);
+          blackHeight = blackHeight ? blackHeight : black;
+          if (black != blackHeight)
+          {
+            throw std::logic_error("Bad black height");
+          }
         }
-        else if (isRed(leaf->right_->left_->right_))
+        else if (getParent(child) != leaf)
         {
-          colorize(leaf->right_->left_->right_, 'b');
-          turnBigLeft(leaf->right_->left_);
+          throw std::logic_error("Bad parent");
         }
-        else
+        else if (isRed(leaf) && isRed(child))
         {
-          colorize(leaf->left_->left_, 'b');
-          turnSmallRight(leaf->left_);
+          throw std::logic_error("Bad color");
         }
       }
-      else
+      if (!isNil(leaf->left_))
       {
-        if (isRed(leaf->right_->left_))
-        {
-          colorize(leaf->right_->left_, 'b');
-          turnBigLeft(leaf->right_->left_);
-        }
-        else if (isBlack(leaf->right_->right_) && isBlack(leaf->right_->left_))
-        {
-          colorize(leaf->right_, 'r');
-          if (leaf->parent_)
-          {
-            balanceDrop(leaf->parent_);
-          }
-        }
-        else
-        {
-          colorize(leaf->right_->right_, 'b');
-          turnSmallLeft(leaf->right_);
-        }
+        next = leaf->left_;
+      }
+      else if (!isNil(leaf->right_))
+      {
+        next = leaf->right_;
       }
     }
+    else if (from == leaf->left_ && !isNil(leaf->right_))
+    {
+      next = leaf->right_;
+    }
+    if (next == getParent(leaf))
+    {
+      black -= isBlack(leaf) ? 1 : 0;
+    }
+    from = leaf;
+    leaf = next;
   }
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::drop(tree_t* leaf)
+template< typename K, typename V, typename C, typename A >
+size_t ivlicheva::BinarySearchTree< K, V, C, A >::size() const
+{
+  return getSize(root_);
+}
+
+template< typename K, typename V, typename C, typename A >
+size_t ivlicheva::BinarySearchTree< K, V, C, A >::rank(const K& k) const
 {
-  if (isRed(leaf))
+  size_t result = 0;
+  tree_t* tmp = root_;
+  while (tmp && !isNil(tmp))
   {
-    if (isNil(leaf->left_) && isNil(leaf->right_))
+    if (isLess(tmp->data_.first, k))
     {
-      if (isLeft(leaf))
-      {
-        leaf->parent_->left_ = nil_;
-      }
-      else
-      {
-        leaf->parent_->right_ = nil_;
-      }
-      delete leaf;
+      result += getSize(tmp->left_) + 1;
+      tmp = tmp->right_;
     }
-    else if (!isNil(leaf->left_) && !isNil(leaf->right_))
+    else
     {
-      if (getHigh(leaf->left_) > getHigh(leaf->right_))
-      {
-        tree_t* maxLeft = getMax(leaf->left_);
-        std::swap(leaf->data_, maxLeft->data_);
-        drop(maxLeft);
-      }
-      else
-      {
-        tree_t* minRight = getMin(leaf->right_);
-        std::swap(leaf->data_, minRight->data_);
-        drop(minRight);
-      }
+      tmp = tmp->left_;
     }
   }
-  else if (isBlack(leaf))
+  return result;
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::Iterator ivlicheva::BinarySearchTree< K, V, C, A >::select(size_t i)
+{
+  return const_cast< const this_t& >(*this).select(i);
+}
+
+template< typename K, typename V, typename C, typename A >
+typename ivlicheva::BinarySearchTree< K, V, C, A >::ConstIterator ivlicheva::BinarySearchTree< K, V, C, A >::select(size_t i) const
+{
+  if (i >= size())
   {
-    if (!isNil(leaf->left_) && isNil(leaf->right_))
-    {
-      std::swap(leaf->data_, leaf->left_->data_);
-      drop(leaf->left_);
-    }
-    else if (isNil(leaf->left_) && !isNil(leaf->right_))
-    {
-      std::swap(leaf->data_, leaf->right_->data_);
-      drop(leaf->right_);
-    }
-    else if (!isNil(leaf->left_) && !isNil(leaf->right_))
+    return cend();
+  }
+  tree_t* tmp = root_;
+  while (i != getSize(tmp->left_))
+  {
+    if (i < getSize(tmp->left_))
     {
-      if (getHigh(leaf->left_) > getHigh(leaf->right_))
-      {
-        tree_t* maxLeft = getMax(leaf->left_);
-        std::swap(leaf->data_, maxLeft->data_);
-        drop(maxLeft);
-      }
-      else
-      {
-        tree_t* minRight = getMin(leaf->right_);
-        std::swap(leaf->data_, minRight->data_);
-        drop(minRight);
-      }
+      tmp = tmp->left_;
     }
-    else if (isNil(leaf->left_) && isNil(leaf->right_))
+    else
     {
-      if (isLeft(leaf))
-      {
-        leaf->parent_->left_ = nil_;
-      }
-      else
-      {
-        leaf->parent_->right_ = nil_;
-      }
-      balanceDrop(leaf->parent_);
-      delete leaf;
+      i -= getSize(tmp->left_) + 1;
+      tmp = tmp->right_;
     }
   }
+  return ConstIterator(tmp, this);
 }
 
-template < typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getMax(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+template< typename T, typename M, typename R >
+T ivlicheva::BinarySearchTree< K, V, C, A >::parallelReduce(M map, R combine, T identity, size_t threads) const
 {
-  if (!leaf)
+  if (!root_)
   {
-    return nil_;
+    return identity;
   }
-  while (!isNil(leaf->right_))
+  threads = threads ? threads : std::thread::hardware_concurrency();
+  std::vector< tree_t* > bounds = getBounds(threads);
+  std::vector< T > results(bounds.size() - 1, identity);
+  runTasks(results.size(), threads, [&](size_t i)
+   {
+     T result = identity;
+     for (tree_t* leaf = bounds[i]; leaf != bounds[i + 1]; leaf = getNext(leaf))
+     {
+       result = combine(std::move(result), map(leaf->data_));
+     }
+     results[i] = std::move(result);
+   });
+  T result = std::move(identity);
+  for (auto&& item: results)
   {
-    leaf = leaf->right_;
+    result = combine(std::move(result), std::move(item));
   }
-  return leaf;
+  return result;
 }
 
-template < typename K, typename V, typename C >
-typename ivlicheva::BinarySearchTree< K, V, C >::tree_t* ivlicheva::BinarySearchTree< K, V, C >::getMin(tree_t* leaf) const
+template< typename K, typename V, typename C, typename A >
+template< typename M, typename F >
+F ivlicheva::BinarySearchTree< K, V, C, A >::parallelForEach(M map, F f, size_t threads) const
 {
-  if (!leaf)
+  if (!root_)
   {
-    return nil_;
+    return f;
   }
-  while (!isNil(leaf->left_))
+  using result_t = typename std::decay< decltype(map(std::declval< const data_t& >())) >::type;
+  threads = threads ? threads : std::thread::hardware_concurrency();
+  std::vector< tree_t* > bounds = getBounds(threads);
+  std::vector< std::vector< result_t > > results(bounds.size() - 1);
+  runTasks(results.size(), threads, [&](size_t i)
+   {
+     for (tree_t* leaf = bounds[i]; leaf != bounds[i + 1]; leaf = getNext(leaf))
+     {
+       results[i].push_back(map(static_cast< const data_t& >(leaf->data_)));
+     }
+   });
+  for (auto&& range: results)
   {
-    leaf = leaf->left_;
+    for (auto&& item: range)
+    {
+      f(std::move(item));
+    }
   }
-  return leaf;
-}
-
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isNil(const tree_t* leaf) const
-{
-  return leaf == nil_;
-}
-
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isRed(const tree_t* leaf) const
-{
-  return leaf->color_ == 'r';
-}
-
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isBlack(const tree_t* leaf) const
-{
-  return leaf->color_ == 'b';
-}
-
-template < typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isEmpty() const noexcept
-{
-  return !root_;
+  return f;
 }
 
-template< typename K, typename V, typename C >
+template< typename K, typename V, typename C, typename A >
 template< typename F >
-F ivlicheva::BinarySearchTree< K, V, C >::traverseLNR(F f) const
+F ivlicheva::BinarySearchTree< K, V, C, A >::forEachValue(F f)
 {
   if (!root_)
   {
     return f;
   }
-  tree_t* tmp = root_;
-  if (isNil(tmp->right_) && !isNil(tmp->left_))
+  for (tree_t* leaf = getMin(root_); !isNil(leaf); leaf = getNext(leaf))
+  {
+    f(leaf->data_.second);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename F >
+F ivlicheva::BinarySearchTree< K, V, C, A >::forEachValue(F f) const
+{
+  if (!root_)
   {
-    f(tmp->left_->data_);
-    f(tmp->data_);
     return f;
   }
-  Stack< tree_t* > stack;
-  stack.push(tmp);
-  while (tmp != getMax(root_))
+  for (tree_t* leaf = getMin(root_); !isNil(leaf); leaf = getNext(leaf))
   {
-    if (!isNil(tmp->left_))
-    {
-      tmp = tmp->left_;
-      stack.push(tmp);
-    }
-    else
-    {
-      f(tmp->data_);
-      stack.drop();
-      if (!stack.isEmpty())
-      {
-        tmp = stack.getTop();
-        f(tmp->data_);
-        stack.drop();
-      }
-      if (!isNil(tmp->right_))
-      {
-        tmp = tmp->right_;
-        stack.push(tmp);
-      }
-      else
-      {
-        tmp = stack.getTop();
-        f(tmp->data_);
-        stack.drop();
-        tmp = tmp->right_;
-        stack.push(tmp);
-      }
-    }
+    f(static_cast< const V& >(leaf->data_.second));
   }
-  f(stack.getTop()->data_);
-  stack.drop();
   return f;
 }
 
-template< typename K, typename V, typename C >
+template< typename K, typename V, typename C, typename A >
 template< typename F >
-F ivlicheva::BinarySearchTree< K, V, C >::traverseRNL(F f) const
+void ivlicheva::BinarySearchTree< K, V, C, A >::parallelForEachValue(F f, size_t threads)
 {
   if (!root_)
   {
-    return f;
+    return;
   }
-  tree_t* tmp = root_;
-  if (isNil(tmp->left_) && !isNil(tmp->right_))
+  threads = threads ? threads : std::thread::hardware_concurrency();
+  std::vector< tree_t* > bounds = getBounds(threads);
+  runTasks(bounds.size() - 1, threads, [&](size_t i)
+   {
+     F local(f);
+     for (tree_t* leaf = bounds[i]; leaf != bounds[i + 1]; leaf = getNext(leaf))
+     {
+       local(leaf->data_.second);
+     }
+   });
+}
+
+template< typename K, typename V, typename C, typename A >
+std::vector< typename ivlicheva::BinarySearchTree< K, V, C, A >::tree_t* > ivlicheva::BinarySearchTree< K, V, C, A >::getBounds(size_t threads) const
+{
+  size_t depth = 1;
+  while ((static_cast< size_t >(1) << depth) < threads * 4)
   {
-    f(tmp->right_->data_);
-    f(tmp->data_);
-    return f;
+    ++depth;
   }
-  Stack< tree_t* > stack;
-  stack.push(tmp);
-  while (tmp != getMin(root_))
+  std::vector< tree_t* > bounds;
+  bounds.push_back(getMin(root_));
+  collectBounds(root_, threads > 1 ? depth : 0, bounds);
+  if (bounds.size() > 1 && bounds[1] == bounds[0])
   {
-    if (!isNil(tmp->right_))
-    {
-      tmp = tmp->right_;
-      stack.push(tmp);
-    }
-    else
-    {
-      f(tmp->data_);
-      stack.drop();
-      if (!stack.isEmpty())
-      {
-        tmp = stack.getTop();
-        f(tmp->data_);
-        stack.drop();
-      }
-      if (!isNil(tmp->left_))
-      {
-        tmp = tmp->left_;
-        stack.push(tmp);
-      }
-      else
-      {
-        tmp = stack.getTop();
-        f(tmp->data_);
-        stack.drop();
-        tmp = tmp->left_;
-        stack.push(tmp);
-      }
-    }
+    bounds.erase(bounds.begin() + 1);
   }
-  f(stack.getTop()->data_);
-  stack.drop();
-  return f;
+  bounds.push_back(nil_);
+  return bounds;
 }
 
-template< typename K, typename V, typename C >
-template< typename F >
-F ivlicheva::BinarySearchTree< K, V, C >::traverseBreadth(F f) const
+template< typename K, typename V, typename C, typename A >
+void ivlicheva::BinarySearchTree< K, V, C, A >::collectBounds(tree_t* leaf, size_t depth, std::vector< tree_t* >& bounds) const
 {
-  if (!root_)
+  if (isNil(leaf) || depth == 0)
   {
-    return f;
+    return;
   }
-  Queue< tree_t* > queue;
-  tree_t* tmp = root_;
-  queue.push(tmp);
-  while (!queue.isEmpty())
+  collectBounds(leaf->left_, depth - 1, bounds);
+  bounds.push_back(leaf);
+  collectBounds(leaf->right_, depth - 1, bounds);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename G >
+void ivlicheva::BinarySearchTree< K, V, C, A >::runTasks(size_t tasks, size_t threads, G task) const
+{
+  std::atomic< size_t > next(0);
+  std::vector< std::exception_ptr > errors(tasks);
+  auto worker = [&]()
+   {
+     for (size_t i = next++; i < tasks; i = next++)
+     {
+       try
+       {
+         task(i);
+       }
+       catch (...)
+       {
+         errors[i] = std::current_exception();
+       }
+     }
+   };
+  std::vector< std::thread > pool;
+  try
   {
-    if (!isNil(tmp->left_))
+    for (size_t i = 1; i < threads && i < tasks; ++i)
     {
-      queue.push(tmp->left_);
+      pool.emplace_back(worker);
     }
-    if (!isNil(tmp->right_))
+  }
+  catch (...)
+  {
+    next = tasks;
+    for (auto&& thread: pool)
     {
-      queue.push(tmp->right_);
+      thread.join();
     }
-    f(queue.getNext()->data_);
-    queue.drop();
-    if (!queue.isEmpty())
+    throw;
+  }
+  worker();
+  for (auto&& thread: pool)
+  {
+    thread.join();
+  }
+  for (auto&& error: errors)
+  {
+    if (error)
     {
-      tmp = queue.getNext();
+      std::rethrow_exception(error);
     }
   }
-  return f;
 }
 
-template< typename K, typename V, typename C >
-void ivlicheva::BinarySearchTree< K, V, C >::colorize(tree_t* leaf, char c)
+template< typename K, typename V, typename C, typename A >
+template< typename K1, typename K2 >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isLess(const K1& k1, const K2& k2) const
 {
-  assert(c == 'b' || c == 'r');
-  leaf->color_ = c;
+  return cmp_(k1, k2);
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isLess(const K& k1, const K& k2) const
+template< typename K, typename V, typename C, typename A >
+template< typename K1, typename K2 >
+int ivlicheva::BinarySearchTree< K, V, C, A >::compare(const K1& k1, const K2& k2) const
 {
-  return cmp_(k1, k2);
+  return compare(k1, k2, detail::HasThreeWay< C >());
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename K1, typename K2 >
+int ivlicheva::BinarySearchTree< K, V, C, A >::compare(const K1& k1, const K2& k2, std::true_type) const
+{
+  return cmp_.compare(k1, k2);
+}
+
+template< typename K, typename V, typename C, typename A >
+template< typename K1, typename K2 >
+int ivlicheva::BinarySearchTree< K, V, C, A >::compare(const K1& k1, const K2& k2, std::false_type) const
+{
+  return isLess(k1, k2) ? -1 : static_cast< int >(isLess(k2, k1));
 }
 
-template< typename K, typename V, typename C >
-bool ivlicheva::BinarySearchTree< K, V, C >::isEqual(const K& k1, const K& k2) const
+template< typename K, typename V, typename C, typename A >
+bool ivlicheva::BinarySearchTree< K, V, C, A >::isEqual(const K& k1, const K& k2) const
 {
-  return !isLess(k1, k2) && !isLess(k2, k1);
+  return !compare(k1, k2);
 }
 
 #endif
@@ -2,22 +2,16 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <utility>
 #include "Dictionary.h"
 #include "iomessages.h"
 #include "IOParse.h"
 
 namespace
 {
-  void checkAndPushDict(ivlicheva::dictionaries_t& dictionaries, ivlicheva::dictionary_t& newDictionary, const std::string& str)
+  void checkAndPushDict(ivlicheva::dictionaries_t& dictionaries, ivlicheva::dictionary_t&& newDictionary, const std::string& str)
   {
-    try
-    {
-      dictionaries.get(str) = newDictionary;
-    }
-    catch (const std::exception&)
-    {
-      dictionaries.push(str, newDictionary);
-    }
+    dictionaries.insertOrAssign(str, std::move(newDictionary));
   }
 }
 
@@ -103,7 +97,7 @@ void ivlicheva::Commands::doComplement(const std::string& str, dictionary_t& dic
       newDictionary.push(i.first, i.second);
     }
   }
-  checkAndPushDict(dictionaries_, newDictionary, str);
+  checkAndPushDict(dictionaries_, std::move(newDictionary), str);
 }
 
 void ivlicheva::Commands::doIntersect(const std::string& str, dictionary_t& dict1, dictionary_t& dict2)
@@ -120,7 +114,7 @@ void ivlicheva::Commands::doIntersect(const std::string& str, dictionary_t& dict
       }
     }
   }
-  checkAndPushDict(dictionaries_, newDictionary, str);
+  checkAndPushDict(dictionaries_, std::move(newDictionary), str);
 }
 
 void ivlicheva::Commands::doUnion(const std::string& str, dictionary_t& dict1, dictionary_t& dict2)
@@ -145,5 +139,5 @@ void ivlicheva::Commands::doUnion(const std::string& str, dictionary_t& dict1, d
       newDictionary.push(i.first, i.second);
     }
   }
-  checkAndPushDict(dictionaries_, newDictionary, str);
+  checkAndPushDict(dictionaries_, std::move(newDictionary), str);
 }
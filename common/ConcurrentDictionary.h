@@ -0,0 +1,333 @@
+#ifndef CONCURRENTDICTIONARY_H
+#define CONCURRENTDICTIONARY_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "BinarySearchTree.h"
+
+namespace ivlicheva
+{
+  namespace detail
+  {
+    class EpochDomain
+    {
+      public:
+        static constexpr size_t maxReaders = 128;
+
+        EpochDomain();
+        EpochDomain(const EpochDomain&) = delete;
+        EpochDomain& operator=(const EpochDomain&) = delete;
+
+        size_t enter() noexcept;
+        void leave(size_t) noexcept;
+        uint64_t advance() noexcept;
+        uint64_t getOldest() const noexcept;
+
+      private:
+        struct alignas(64) slot_t
+        {
+          std::atomic< uint64_t > epoch_;
+        };
+
+        slot_t slots_[maxReaders];
+        alignas(64) std::atomic< uint64_t > epoch_;
+    };
+  }
+
+  template< typename Key, typename Value, typename Compare, typename Backend = RedBlackBackend >
+  class ConcurrentDictionary
+  {
+    public:
+      class Snapshot;
+      using tree_t = typename Backend::template tree_t< Key, Value, Compare >;
+      using this_t = ConcurrentDictionary< Key, Value, Compare, Backend >;
+
+      ConcurrentDictionary();
+      explicit ConcurrentDictionary(const tree_t&);
+      ConcurrentDictionary(const this_t&) = delete;
+      ~ConcurrentDictionary();
+
+      this_t& operator=(const this_t&) = delete;
+
+      Snapshot getSnapshot() const;
+      Value get(const Key&) const;
+      bool isEmpty() const;
+      void push(const Key&, const Value&);
+      void drop(const Key&);
+      template< typename F >
+      void update(F);
+
+    private:
+      struct version_t
+      {
+        tree_t tree_;
+        uint64_t retired_;
+        version_t* next_;
+      };
+
+      std::atomic< version_t* > current_;
+      mutable detail::EpochDomain domain_;
+      std::mutex writer_;
+      version_t* retired_;
+
+      void publish(version_t*);
+      void reclaim() noexcept;
+  };
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+class ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot
+{
+  public:
+    friend class ConcurrentDictionary< Key, Value, Compare, Backend >;
+    using citerator_t = typename tree_t::ConstIterator;
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot(Snapshot&&) noexcept;
+    ~Snapshot();
+
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    const tree_t& operator*() const;
+    const tree_t* operator->() const;
+    const Value& get(const Key&) const;
+    citerator_t begin() const;
+    citerator_t end() const;
+
+  private:
+    detail::EpochDomain* domain_;
+    size_t slot_;
+    const version_t* version_;
+    Snapshot(detail::EpochDomain*, size_t, const version_t*);
+};
+
+inline ivlicheva::detail::EpochDomain::EpochDomain():
+  epoch_(1)
+{
+  for (size_t i = 0; i < maxReaders; ++i)
+  {
+    slots_[i].epoch_.store(0, std::memory_order_relaxed);
+  }
+}
+
+inline size_t ivlicheva::detail::EpochDomain::enter() noexcept
+{
+  thread_local size_t hint = std::hash< std::thread::id >()(std::this_thread::get_id());
+  while (true)
+  {
+    uint64_t epoch = epoch_.load();
+    for (size_t i = 0; i < maxReaders; ++i)
+    {
+      size_t slot = (hint + i) % maxReaders;
+      uint64_t expected = 0;
+      if (slots_[slot].epoch_.load(std::memory_order_relaxed) == 0 && slots_[slot].epoch_.compare_exchange_strong(expected, epoch))
+      {
+        hint = slot;
+        return slot;
+      }
+    }
+    std::this_thread::yield();
+  }
+}
+
+inline void ivlicheva::detail::EpochDomain::leave(size_t slot) noexcept
+{
+  slots_[slot].epoch_.store(0, std::memory_order_release);
+}
+
+inline uint64_t ivlicheva::detail::EpochDomain::advance() noexcept
+{
+  return epoch_.fetch_add(1) + 1;
+}
+
+inline uint64_t ivlicheva::detail::EpochDomain::getOldest() const noexcept
+{
+  uint64_t oldest = epoch_.load();
+  for (size_t i = 0; i < maxReaders; ++i)
+  {
+    uint64_t epoch = slots_[i].epoch_.load();
+    if (epoch && epoch < oldest)
+    {
+      oldest = epoch;
+    }
+  }
+  return oldest;
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::Snapshot(detail::EpochDomain* domain, size_t slot, const version_t* version):
+  domain_(domain),
+  slot_(slot),
+  version_(version)
+{}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::Snapshot(Snapshot&& ob) noexcept:
+  domain_(ob.domain_),
+  slot_(ob.slot_),
+  version_(ob.version_)
+{
+  ob.domain_ = nullptr;
+  ob.version_ = nullptr;
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::~Snapshot()
+{
+  if (domain_)
+  {
+    domain_->leave(slot_);
+  }
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+const typename ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::tree_t& ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::operator*() const
+{
+  return version_->tree_;
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+const typename ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::tree_t* ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::operator->() const
+{
+  return std::addressof(version_->tree_);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+const Value& ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::get(const Key& k) const
+{
+  citerator_t iter = version_->tree_.find(k);
+  if (iter == version_->tree_.cend())
+  {
+    throw std::logic_error("Error in get");
+  }
+  return iter->second;
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::citerator_t ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::begin() const
+{
+  return version_->tree_.cbegin();
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::citerator_t ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot::end() const
+{
+  return version_->tree_.cend();
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::ConcurrentDictionary():
+  ConcurrentDictionary(tree_t())
+{}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::ConcurrentDictionary(const tree_t& tree):
+  current_(new version_t{tree, 0, nullptr}),
+  domain_(),
+  writer_(),
+  retired_(nullptr)
+{}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::~ConcurrentDictionary()
+{
+  while (retired_)
+  {
+    version_t* next = retired_->next_;
+    delete retired_;
+    retired_ = next;
+  }
+  delete current_.load();
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::Snapshot ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::getSnapshot() const
+{
+  size_t slot = domain_.enter();
+  return Snapshot(std::addressof(domain_), slot, current_.load());
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+Value ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::get(const Key& k) const
+{
+  return getSnapshot().get(k);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+bool ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::isEmpty() const
+{
+  return getSnapshot()->isEmpty();
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::push(const Key& k, const Value& v)
+{
+  update([&](tree_t& tree)
+   {
+     tree.push(k, v);
+   });
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::drop(const Key& k)
+{
+  update([&](tree_t& tree)
+   {
+     tree.drop(k);
+   });
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename F >
+void ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::update(F f)
+{
+  std::lock_guard< std::mutex > lock(writer_);
+  version_t* version = new version_t{current_.load()->tree_, 0, nullptr};
+  try
+  {
+    f(version->tree_);
+  }
+  catch (...)
+  {
+    delete version;
+    throw;
+  }
+  publish(version);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::publish(version_t* version)
+{
+  version_t* old = current_.exchange(version);
+  old->retired_ = domain_.advance();
+  old->next_ = retired_;
+  retired_ = old;
+  reclaim();
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::ConcurrentDictionary< Key, Value, Compare, Backend >::reclaim() noexcept
+{
+  uint64_t oldest = domain_.getOldest();
+  version_t** link = std::addressof(retired_);
+  while (*link)
+  {
+    version_t* version = *link;
+    if (version->retired_ <= oldest)
+    {
+      *link = version->next_;
+      delete version;
+    }
+    else
+    {
+      link = std::addressof(version->next_);
+    }
+  }
+}
+
+#endif
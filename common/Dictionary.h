@@ -4,16 +4,20 @@
 #include <stdexcept>
 #include <utility>
 #include "BinarySearchTree.h"
+#include "BPlusTree.h"
+#include "PersistentTree.h"
+#include "RadixTree.h"
 
 namespace ivlicheva
 {
-  template< typename Key, typename Value, typename Compare >
+  template< typename Key, typename Value, typename Compare, typename Backend = RedBlackBackend >
   class Dictionary
   {
     public:
       using data_t = typename std::pair< Key, Value >;
-      using iterator_t = typename BinarySearchTree< Key, Value, Compare >::Iterator;
-      using citerator_t = typename BinarySearchTree< Key, Value, Compare >::ConstIterator;
+      using tree_t = typename Backend::template tree_t< Key, Value, Compare >;
+      using iterator_t = typename tree_t::Iterator;
+      using citerator_t = typename tree_t::ConstIterator;
 
       Dictionary() = default;
       Dictionary(const Dictionary&) = default;
@@ -21,33 +25,53 @@ namespace ivlicheva
       Dictionary(std::initializer_list< std::pair< Key, Value > >);
       ~Dictionary() = default;
 
-      Dictionary< Key, Value, Compare >& operator=(const Dictionary< Key, Value, Compare >&) = default;
-      Dictionary< Key, Value, Compare >& operator=(Dictionary< Key, Value, Compare >&&) noexcept = default;
+      Dictionary< Key, Value, Compare, Backend >& operator=(const Dictionary< Key, Value, Compare, Backend >&) = default;
+      Dictionary< Key, Value, Compare, Backend >& operator=(Dictionary< Key, Value, Compare, Backend >&&) noexcept = default;
 
       void push(const Key&, const Value&);
+      void push(Key&&, Value&&);
+      template< typename... Args >
+      void emplace(const Key&, Args&&...);
+      template< typename... Args >
+      std::pair< iterator_t, bool > tryEmplace(const Key&, Args&&...);
+      template< typename... Args >
+      std::pair< iterator_t, bool > tryEmplace(Key&&, Args&&...);
+      template< typename M >
+      std::pair< iterator_t, bool > insertOrAssign(const Key&, M&&);
+      template< typename M >
+      std::pair< iterator_t, bool > insertOrAssign(Key&&, M&&);
       Value& get(const Key&);
       const Value& get(const Key&) const;
       void drop(const Key&);
+      template< typename Q, typename D = Compare, typename = typename D::is_transparent >
+      Value& get(const Q&);
+      template< typename Q, typename D = Compare, typename = typename D::is_transparent >
+      const Value& get(const Q&) const;
+      template< typename Q, typename D = Compare, typename = typename D::is_transparent >
+      void drop(const Q&);
+      template< typename It >
+      void assignSorted(It, It);
+      void freeze();
       iterator_t begin();
       iterator_t end();
+      citerator_t begin() const;
+      citerator_t end() const;
       citerator_t cbegin();
       citerator_t cend();
       bool isEmpty() const noexcept;
 
     private:
-      BinarySearchTree< Key, Value, Compare > data_;
-      bool isEqual(const Key&, const Key&) const;
-      bool isNotEqual(const Key&, const Key&) const;
+      tree_t data_;
   };
 
-  template< typename Key, typename Value, typename Compare >
-  using dict_iter_t = typename BinarySearchTree< Key, Value, Compare >::Iterator;
-  template< typename Key, typename Value, typename Compare >
-  using dict_citer_t = typename BinarySearchTree< Key, Value, Compare >::ConstIterator;
+  template< typename Key, typename Value, typename Compare, typename Backend = RedBlackBackend >
+  using dict_iter_t = typename Backend::template tree_t< Key, Value, Compare >::Iterator;
+  template< typename Key, typename Value, typename Compare, typename Backend = RedBlackBackend >
+  using dict_citer_t = typename Backend::template tree_t< Key, Value, Compare >::ConstIterator;
 }
 
-template< typename Key, typename Value, typename Compare >
-ivlicheva::Dictionary< Key, Value, Compare >::Dictionary(std::initializer_list< std::pair< Key, Value > > il):
+template< typename Key, typename Value, typename Compare, typename Backend >
+ivlicheva::Dictionary< Key, Value, Compare, Backend >::Dictionary(std::initializer_list< std::pair< Key, Value > > il):
   data_()
 {
   for (auto&& item: il)
@@ -56,80 +80,165 @@ ivlicheva::Dictionary< Key, Value, Compare >::Dictionary(std::initializer_list<
   }
 }
 
-template< typename Key, typename Value, typename Compare >
-void ivlicheva::Dictionary< Key, Value, Compare >::push(const Key& k, const Value& v)
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::push(const Key& k, const Value& v)
 {
   data_.push(k, v);
 }
 
-template< typename Key, typename Value, typename Compare >
-Value& ivlicheva::Dictionary< Key, Value, Compare >::get(const Key& k)
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::push(Key&& k, Value&& v)
 {
-  return const_cast< Value& >(static_cast< const Dictionary< Key, Value, Compare >& >(*this).get(k));
+  data_.push(std::move(k), std::move(v));
 }
 
-template< typename Key, typename Value, typename Compare >
-const Value& ivlicheva::Dictionary< Key, Value, Compare >::get(const Key& k) const
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename... Args >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::emplace(const Key& k, Args&&... args)
 {
-  typename ivlicheva::BinarySearchTree< Key, Value, Compare >::Iterator iter;
-  iter = data_.begin();
-  while (iter != data_.end() && isNotEqual(iter->first, k))
+  data_.emplace(k, std::forward< Args >(args)...);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename... Args >
+std::pair< typename ivlicheva::Dictionary< Key, Value, Compare, Backend >::iterator_t, bool > ivlicheva::Dictionary< Key, Value, Compare, Backend >::tryEmplace(const Key& k, Args&&... args)
+{
+  return data_.tryEmplace(k, std::forward< Args >(args)...);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename... Args >
+std::pair< typename ivlicheva::Dictionary< Key, Value, Compare, Backend >::iterator_t, bool > ivlicheva::Dictionary< Key, Value, Compare, Backend >::tryEmplace(Key&& k, Args&&... args)
+{
+  return data_.tryEmplace(std::move(k), std::forward< Args >(args)...);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename M >
+std::pair< typename ivlicheva::Dictionary< Key, Value, Compare, Backend >::iterator_t, bool > ivlicheva::Dictionary< Key, Value, Compare, Backend >::insertOrAssign(const Key& k, M&& obj)
+{
+  return data_.insertOrAssign(k, std::forward< M >(obj));
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename M >
+std::pair< typename ivlicheva::Dictionary< Key, Value, Compare, Backend >::iterator_t, bool > ivlicheva::Dictionary< Key, Value, Compare, Backend >::insertOrAssign(Key&& k, M&& obj)
+{
+  return data_.insertOrAssign(std::move(k), std::forward< M >(obj));
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+Value& ivlicheva::Dictionary< Key, Value, Compare, Backend >::get(const Key& k)
+{
+  iterator_t iter = data_.find(k);
+  if (iter == data_.end())
+  {
+    throw std::logic_error("Error in get");
+  }
+  return const_cast< Value& >(iter->second);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+const Value& ivlicheva::Dictionary< Key, Value, Compare, Backend >::get(const Key& k) const
+{
+  citerator_t iter = data_.find(k);
+  if (iter == data_.cend())
   {
-    ++iter;
+    throw std::logic_error("Error in get");
   }
+  return iter->second;
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::drop(const Key& k)
+{
+  data_.drop(k);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename Q, typename D, typename >
+Value& ivlicheva::Dictionary< Key, Value, Compare, Backend >::get(const Q& k)
+{
+  iterator_t iter = data_.find(k);
   if (iter == data_.end())
   {
     throw std::logic_error("Error in get");
   }
+  return const_cast< Value& >(iter->second);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename Q, typename D, typename >
+const Value& ivlicheva::Dictionary< Key, Value, Compare, Backend >::get(const Q& k) const
+{
+  citerator_t iter = data_.find(k);
+  if (iter == data_.cend())
+  {
+    throw std::logic_error("Error in get");
+  }
   return iter->second;
 }
 
-template< typename Key, typename Value, typename Compare >
-void ivlicheva::Dictionary< Key, Value, Compare >::drop(const Key& k)
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename Q, typename D, typename >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::drop(const Q& k)
 {
   data_.drop(k);
 }
 
-template< typename Key, typename Value, typename Compare >
-typename ivlicheva::dict_iter_t< Key, Value, Compare > ivlicheva::Dictionary< Key, Value, Compare >::begin()
+template< typename Key, typename Value, typename Compare, typename Backend >
+template< typename It >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::assignSorted(It first, It last)
+{
+  data_.assignSorted(first, last);
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+void ivlicheva::Dictionary< Key, Value, Compare, Backend >::freeze()
+{
+  data_.freeze();
+}
+
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::dict_iter_t< Key, Value, Compare, Backend > ivlicheva::Dictionary< Key, Value, Compare, Backend >::begin()
 {
   return data_.begin();
 }
 
-template< typename Key, typename Value, typename Compare >
-typename ivlicheva::dict_iter_t< Key, Value, Compare > ivlicheva::Dictionary< Key, Value, Compare >::end()
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::dict_iter_t< Key, Value, Compare, Backend > ivlicheva::Dictionary< Key, Value, Compare, Backend >::end()
 {
   return data_.end();
 }
 
-template< typename Key, typename Value, typename Compare >
-typename ivlicheva::dict_citer_t< Key, Value, Compare > ivlicheva::Dictionary< Key, Value, Compare >::cbegin()
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::dict_citer_t< Key, Value, Compare, Backend > ivlicheva::Dictionary< Key, Value, Compare, Backend >::begin() const
 {
   return data_.cbegin();
 }
 
-template< typename Key, typename Value, typename Compare >
-typename ivlicheva::dict_citer_t< Key, Value, Compare > ivlicheva::Dictionary< Key, Value, Compare >::cend()
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::dict_citer_t< Key, Value, Compare, Backend > ivlicheva::Dictionary< Key, Value, Compare, Backend >::end() const
 {
   return data_.cend();
 }
 
-template< typename Key, typename Value, typename Compare >
-bool ivlicheva::Dictionary< Key, Value, Compare >::isEmpty() const noexcept
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::dict_citer_t< Key, Value, Compare, Backend > ivlicheva::Dictionary< Key, Value, Compare, Backend >::cbegin()
 {
-  return data_.isEmpty();
+  return data_.cbegin();
 }
 
-template< typename Key, typename Value, typename Compare >
-bool ivlicheva::Dictionary< Key, Value, Compare >::isEqual(const Key& k1, const Key& k2) const
+template< typename Key, typename Value, typename Compare, typename Backend >
+typename ivlicheva::dict_citer_t< Key, Value, Compare, Backend > ivlicheva::Dictionary< Key, Value, Compare, Backend >::cend()
 {
-  return !Compare()(k1, k2) && !Compare()(k2, k1);
+  return data_.cend();
 }
 
-template< typename Key, typename Value, typename Compare >
-bool ivlicheva::Dictionary< Key, Value, Compare >::isNotEqual(const Key& k1, const Key& k2) const
+template< typename Key, typename Value, typename Compare, typename Backend >
+bool ivlicheva::Dictionary< Key, Value, Compare, Backend >::isEmpty() const noexcept
 {
-  return !isEqual(k1, k2);
+  return data_.isEmpty();
 }
 
 #endif
@@ -0,0 +1,179 @@
+#ifndef EYTZINGERINDEX_H
+#define EYTZINGERINDEX_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ivlicheva
+{
+  namespace detail
+  {
+    template< typename K, typename T, typename C >
+    class EytzingerIndex
+    {
+      public:
+        EytzingerIndex();
+        EytzingerIndex(const EytzingerIndex< K, T, C >&) = default;
+        EytzingerIndex(EytzingerIndex< K, T, C >&&) noexcept = default;
+        ~EytzingerIndex() = default;
+
+        EytzingerIndex< K, T, C >& operator=(const EytzingerIndex< K, T, C >&) = default;
+        EytzingerIndex< K, T, C >& operator=(EytzingerIndex< K, T, C >&&) noexcept = default;
+
+        template< typename F >
+        void assign(const std::vector< T >&, F);
+        void clear() noexcept;
+        void swap(EytzingerIndex< K, T, C >&) noexcept;
+        bool isBuilt() const noexcept;
+        size_t size() const noexcept;
+        template< typename Q >
+        size_t getFirstNotLess(const Q&) const;
+        template< typename Q >
+        size_t getFirstGreater(const Q&) const;
+        const K& getKey(size_t) const noexcept;
+        const T& getValue(size_t) const noexcept;
+
+      private:
+        std::vector< K > keys_;
+        std::vector< T > values_;
+        size_t size_;
+        bool isBuilt_;
+        C cmp_;
+
+        template< typename F >
+        size_t fill(const std::vector< T >&, F&, size_t, size_t);
+        void prefetch(size_t) const noexcept;
+        static size_t getResult(size_t) noexcept;
+    };
+  }
+}
+
+template< typename K, typename T, typename C >
+ivlicheva::detail::EytzingerIndex< K, T, C >::EytzingerIndex():
+  keys_(),
+  values_(),
+  size_(0),
+  isBuilt_(false),
+  cmp_()
+{}
+
+template< typename K, typename T, typename C >
+template< typename F >
+void ivlicheva::detail::EytzingerIndex< K, T, C >::assign(const std::vector< T >& sorted, F getKey)
+{
+  EytzingerIndex< K, T, C > tmp;
+  tmp.size_ = sorted.size();
+  if (tmp.size_)
+  {
+    tmp.keys_.assign(tmp.size_ + 1, getKey(sorted.front()));
+    tmp.values_.assign(tmp.size_ + 1, sorted.front());
+    tmp.fill(sorted, getKey, 0, 1);
+  }
+  tmp.isBuilt_ = true;
+  swap(tmp);
+}
+
+template< typename K, typename T, typename C >
+void ivlicheva::detail::EytzingerIndex< K, T, C >::clear() noexcept
+{
+  if (isBuilt_)
+  {
+    std::vector< K >().swap(keys_);
+    std::vector< T >().swap(values_);
+    size_ = 0;
+    isBuilt_ = false;
+  }
+}
+
+template< typename K, typename T, typename C >
+void ivlicheva::detail::EytzingerIndex< K, T, C >::swap(EytzingerIndex< K, T, C >& ob) noexcept
+{
+  keys_.swap(ob.keys_);
+  values_.swap(ob.values_);
+  std::swap(size_, ob.size_);
+  std::swap(isBuilt_, ob.isBuilt_);
+  std::swap(cmp_, ob.cmp_);
+}
+
+template< typename K, typename T, typename C >
+bool ivlicheva::detail::EytzingerIndex< K, T, C >::isBuilt() const noexcept
+{
+  return isBuilt_;
+}
+
+template< typename K, typename T, typename C >
+size_t ivlicheva::detail::EytzingerIndex< K, T, C >::size() const noexcept
+{
+  return size_;
+}
+
+template< typename K, typename T, typename C >
+template< typename Q >
+size_t ivlicheva::detail::EytzingerIndex< K, T, C >::getFirstNotLess(const Q& k) const
+{
+  size_t i = 1;
+  while (i <= size_)
+  {
+    prefetch(i);
+    i = 2 * i + static_cast< size_t >(cmp_(keys_[i], k));
+  }
+  return getResult(i);
+}
+
+template< typename K, typename T, typename C >
+template< typename Q >
+size_t ivlicheva::detail::EytzingerIndex< K, T, C >::getFirstGreater(const Q& k) const
+{
+  size_t i = 1;
+  while (i <= size_)
+  {
+    prefetch(i);
+    i = 2 * i + static_cast< size_t >(!cmp_(k, keys_[i]));
+  }
+  return getResult(i);
+}
+
+template< typename K, typename T, typename C >
+const K& ivlicheva::detail::EytzingerIndex< K, T, C >::getKey(size_t i) const noexcept
+{
+  return keys_[i];
+}
+
+template< typename K, typename T, typename C >
+const T& ivlicheva::detail::EytzingerIndex< K, T, C >::getValue(size_t i) const noexcept
+{
+  return values_[i];
+}
+
+template< typename K, typename T, typename C >
+template< typename F >
+size_t ivlicheva::detail::EytzingerIndex< K, T, C >::fill(const std::vector< T >& sorted, F& getKey, size_t pos, size_t i)
+{
+  if (i <= size_)
+  {
+    pos = fill(sorted, getKey, pos, 2 * i);
+    keys_[i] = getKey(sorted[pos]);
+    values_[i] = sorted[pos];
+    pos = fill(sorted, getKey, pos + 1, 2 * i + 1);
+  }
+  return pos;
+}
+
+template< typename K, typename T, typename C >
+void ivlicheva::detail::EytzingerIndex< K, T, C >::prefetch(size_t i) const noexcept
+{
+  constexpr size_t ahead = 64 / sizeof(K) < 2 ? 2 : 64 / sizeof(K);
+  if (i * ahead <= size_)
+  {
+    __builtin_prefetch(keys_.data() + i * ahead);
+  }
+}
+
+template< typename K, typename T, typename C >
+size_t ivlicheva::detail::EytzingerIndex< K, T, C >::getResult(size_t i) noexcept
+{
+  return i >> (__builtin_ctzll(~static_cast< unsigned long long >(i)) + 1);
+}
+
+#endif
@@ -1,12 +1,15 @@
 #include "IODataset.h"
-#include <fstream>
 #include <string>
+#include <utility>
+#include <experimental/string_view>
 #include "Dictionary.h"
 #include "IOParse.h"
+#include "MappedLineReader.h"
+#include "Snapshot.h"
 
 namespace
 {
-  ivlicheva::dictionary_t splitStringToDictionary(std::string str)
+  ivlicheva::dictionary_t splitStringToDictionary(std::experimental::string_view str)
   {
     ivlicheva::dictionary_t dictionary;
     if (str.empty())
@@ -15,38 +18,61 @@ namespace
     }
     while (str.size())
     {
-      std::string keyS = ivlicheva::getSubstring(str);
+      std::experimental::string_view keyS = ivlicheva::takeWord(str);
       if (str.empty())
       {
         break;
       }
-      int key = std::stoi(keyS);
-      std::string data = ivlicheva::getSubstring(str);
-      dictionary.push(key, data);
+      int key = std::stoi(keyS.to_string());
+      dictionary.emplace(key, ivlicheva::takeWord(str).to_string());
     }
     return dictionary;
   }
 }
 
-ivlicheva::dictionaries_t ivlicheva::readDictionariesFromFile(std::istream& file)
+ivlicheva::dictionaries_t ivlicheva::readDictionariesFromFile(MappedLineReader& file)
 {
   dictionaries_t dictionaries;
-  while (!file.eof())
+  std::experimental::string_view str;
+  while (file.getLine(str))
   {
-    std::string str = "";
-    std::getline(file, str);
     if (str.size())
     {
-      std::string name = getSubstring(str);
+      std::string name = takeWord(str).to_string();
       if (str.empty())
       {
-        dictionaries.push(name, dictionary_t{});
+        dictionaries.tryEmplace(std::move(name));
       }
       else if (str.size())
       {
-        dictionaries.push(name, splitStringToDictionary(str));
+        dictionaries.tryEmplace(std::move(name), splitStringToDictionary(str));
       }
     }
   }
   return dictionaries;
 }
+
+ivlicheva::dictionaries_t ivlicheva::readDictionariesFromSnapshot(const std::string& path)
+{
+  using snapshot_t = Snapshot< int, std::string, std::less< int > >;
+  snapshot_t snapshot(path);
+  dictionaries_t dictionaries;
+  for (size_t i = 0; i < snapshot.getSectionCount(); ++i)
+  {
+    snapshot_t::View section = snapshot.getSection(i);
+    dictionary_t dictionary;
+    dictionary.assignSorted(section.begin(), section.end());
+    dictionaries.tryEmplace(std::string(snapshot.getName(i)), std::move(dictionary));
+  }
+  return dictionaries;
+}
+
+void ivlicheva::writeDictionariesToSnapshot(const std::string& path, const dictionaries_t& dictionaries)
+{
+  SnapshotWriter< int, std::string > writer;
+  for (auto&& item: dictionaries)
+  {
+    writer.addSection(item.first, item.second.begin(), item.second.end());
+  }
+  writer.save(path);
+}
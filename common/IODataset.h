@@ -4,12 +4,16 @@
 #include <string>
 #include <iosfwd>
 #include "Dictionary.h"
+#include "HashDictionary.h"
+#include "MappedLineReader.h"
 
 namespace ivlicheva
 {
-  using dictionary_t = Dictionary< int, std::string, std::less< int > >;
-  using dictionaries_t = Dictionary< std::string, dictionary_t, std::less< std::string > >;
-  dictionaries_t readDictionariesFromFile(std::istream& file);
+  using dictionary_t = Dictionary< int, std::string, std::less< int >, PersistentBackend >;
+  using dictionaries_t = HashDictionary< std::string, dictionary_t, StringHash, StringEqual >;
+  dictionaries_t readDictionariesFromFile(MappedLineReader& file);
+  dictionaries_t readDictionariesFromSnapshot(const std::string& path);
+  void writeDictionariesToSnapshot(const std::string& path, const dictionaries_t& dictionaries);
 }
 
 #endif
@@ -1,5 +1,6 @@
 #include "IOParse.h"
 #include <string>
+#include <experimental/string_view>
 
 std::string ivlicheva::getSubstring(std::string& str)
 {
@@ -9,3 +10,24 @@ std::string ivlicheva::getSubstring(std::string& str)
   str.erase(0, n);
   return word;
 }
+
+std::experimental::string_view ivlicheva::getWord(const std::string& str)
+{
+  size_t n = str.find_first_of(' ', 0);
+  return std::experimental::string_view(str.data(), (n == str.npos) ? str.size() : n);
+}
+
+void ivlicheva::dropWord(std::string& str)
+{
+  size_t n = str.find_first_of(' ', 0);
+  n = (n == str.npos) ? n : n + 1;
+  str.erase(0, n);
+}
+
+std::experimental::string_view ivlicheva::takeWord(std::experimental::string_view& str)
+{
+  size_t n = str.find_first_of(' ', 0);
+  std::experimental::string_view word = str.substr(0, n);
+  str.remove_prefix((n == str.npos) ? str.size() : n + 1);
+  return word;
+}
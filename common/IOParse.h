@@ -2,10 +2,14 @@
 #define PARSEIO_H
 
 #include <string>
+#include <experimental/string_view>
 
 namespace ivlicheva
 {
   std::string getSubstring(std::string&);
+  std::experimental::string_view getWord(const std::string&);
+  void dropWord(std::string&);
+  std::experimental::string_view takeWord(std::experimental::string_view&);
 }
 
 #endif
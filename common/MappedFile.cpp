@@ -0,0 +1,85 @@
+#include "MappedFile.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ivlicheva::MappedFile::MappedFile() noexcept:
+  data_(nullptr),
+  size_(0)
+{}
+
+ivlicheva::MappedFile::MappedFile(const std::string& path):
+  MappedFile()
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    throw std::logic_error("Bad file");
+  }
+  struct stat info;
+  if (::fstat(fd, std::addressof(info)) != 0)
+  {
+    ::close(fd);
+    throw std::logic_error("Bad file");
+  }
+  size_ = static_cast< size_t >(info.st_size);
+  if (size_)
+  {
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      ::close(fd);
+      throw std::logic_error("Bad file");
+    }
+    ::madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast< const char* >(data);
+  }
+  ::close(fd);
+}
+
+ivlicheva::MappedFile::MappedFile(MappedFile&& ob) noexcept:
+  data_(ob.data_),
+  size_(ob.size_)
+{
+  ob.data_ = nullptr;
+  ob.size_ = 0;
+}
+
+ivlicheva::MappedFile::~MappedFile()
+{
+  if (data_)
+  {
+    ::munmap(const_cast< char* >(data_), size_);
+  }
+}
+
+ivlicheva::MappedFile& ivlicheva::MappedFile::operator=(MappedFile&& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    MappedFile tmp(std::move(ob));
+    swap(tmp);
+  }
+  return *this;
+}
+
+void ivlicheva::MappedFile::swap(MappedFile& ob) noexcept
+{
+  std::swap(data_, ob.data_);
+  std::swap(size_, ob.size_);
+}
+
+const char* ivlicheva::MappedFile::data() const noexcept
+{
+  return data_;
+}
+
+size_t ivlicheva::MappedFile::size() const noexcept
+{
+  return size_;
+}
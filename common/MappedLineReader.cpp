@@ -0,0 +1,79 @@
+#include "MappedLineReader.h"
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <experimental/string_view>
+
+ivlicheva::MappedLineReader::MappedLineReader(const std::string& path):
+  file_(path),
+  in_(nullptr),
+  buffer_(),
+  capacity_(0),
+  begin_(file_.data()),
+  end_(file_.data() + file_.size())
+{}
+
+ivlicheva::MappedLineReader::MappedLineReader(std::istream& in):
+  file_(),
+  in_(std::addressof(in)),
+  buffer_(new char[bufferSize]),
+  capacity_(bufferSize),
+  begin_(buffer_.get()),
+  end_(buffer_.get())
+{}
+
+bool ivlicheva::MappedLineReader::getLine(std::experimental::string_view& line)
+{
+  size_t scanned = 0;
+  const void* newline = begin_ != end_ ? std::memchr(begin_, '\n', end_ - begin_) : nullptr;
+  while (!newline)
+  {
+    scanned = end_ - begin_;
+    if (!refill())
+    {
+      break;
+    }
+    newline = std::memchr(begin_ + scanned, '\n', end_ - begin_ - scanned);
+  }
+  if (newline)
+  {
+    const char* last = static_cast< const char* >(newline);
+    line = std::experimental::string_view(begin_, last - begin_);
+    begin_ = last + 1;
+    return true;
+  }
+  if (begin_ == end_)
+  {
+    return false;
+  }
+  line = std::experimental::string_view(begin_, end_ - begin_);
+  begin_ = end_;
+  return true;
+}
+
+bool ivlicheva::MappedLineReader::refill()
+{
+  if (!in_ || !*in_)
+  {
+    return false;
+  }
+  size_t size = end_ - begin_;
+  if (size == capacity_)
+  {
+    std::unique_ptr< char[] > buffer(new char[capacity_ * 2]);
+    std::memcpy(buffer.get(), begin_, size);
+    buffer_ = std::move(buffer);
+    capacity_ *= 2;
+  }
+  else if (size)
+  {
+    std::memmove(buffer_.get(), begin_, size);
+  }
+  begin_ = buffer_.get();
+  end_ = begin_ + size;
+  in_->read(buffer_.get() + size, capacity_ - size);
+  end_ += in_->gcount();
+  return in_->gcount() > 0;
+}
@@ -0,0 +1,151 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <utility>
+#include <new>
+#include <memory>
+#include <type_traits>
+
+namespace ivlicheva
+{
+  namespace detail
+  {
+    template< typename T >
+    class NodePool
+    {
+      public:
+        NodePool();
+        NodePool(const NodePool< T >&) = delete;
+        NodePool(NodePool< T >&& ob) noexcept;
+        ~NodePool();
+
+        NodePool< T >& operator=(const NodePool< T >&) = delete;
+        NodePool< T >& operator=(NodePool< T >&& ob) noexcept;
+
+        T* allocate();
+        void deallocate(T* p) noexcept;
+        void swap(NodePool< T >& ob) noexcept;
+
+      private:
+        union slot_t
+        {
+          slot_t* next_;
+          typename std::aligned_storage< sizeof(T), alignof(T) >::type value_;
+        };
+        struct block_t
+        {
+          block_t* next_;
+          size_t size_;
+        };
+
+        block_t* blocks_;
+        slot_t* free_;
+        size_t used_;
+
+        void release() noexcept;
+        slot_t* getSlots(block_t* block) const noexcept;
+        static size_t getHeaderSize() noexcept;
+    };
+  }
+}
+
+template< typename T >
+ivlicheva::detail::NodePool< T >::NodePool():
+  blocks_(nullptr),
+  free_(nullptr),
+  used_(0)
+{}
+
+template< typename T >
+ivlicheva::detail::NodePool< T >::NodePool(NodePool< T >&& ob) noexcept:
+  blocks_(ob.blocks_),
+  free_(ob.free_),
+  used_(ob.used_)
+{
+  ob.blocks_ = nullptr;
+  ob.free_ = nullptr;
+  ob.used_ = 0;
+}
+
+template< typename T >
+ivlicheva::detail::NodePool< T >::~NodePool()
+{
+  release();
+}
+
+template< typename T >
+ivlicheva::detail::NodePool< T >& ivlicheva::detail::NodePool< T >::operator=(NodePool< T >&& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    NodePool< T > tmp(std::move(ob));
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename T >
+T* ivlicheva::detail::NodePool< T >::allocate()
+{
+  if (free_)
+  {
+    slot_t* slot = free_;
+    free_ = free_->next_;
+    return reinterpret_cast< T* >(slot);
+  }
+  if (!blocks_ || used_ == blocks_->size_)
+  {
+    size_t size = blocks_ ? blocks_->size_ * 2 : 16;
+    size = size > 4096 ? 4096 : size;
+    block_t* block = static_cast< block_t* >(operator new(getHeaderSize() + sizeof(slot_t) * size));
+    block->next_ = blocks_;
+    block->size_ = size;
+    blocks_ = block;
+    used_ = 0;
+  }
+  return reinterpret_cast< T* >(getSlots(blocks_) + used_++);
+}
+
+template< typename T >
+void ivlicheva::detail::NodePool< T >::deallocate(T* p) noexcept
+{
+  slot_t* slot = reinterpret_cast< slot_t* >(p);
+  slot->next_ = free_;
+  free_ = slot;
+}
+
+template< typename T >
+void ivlicheva::detail::NodePool< T >::swap(NodePool< T >& ob) noexcept
+{
+  std::swap(blocks_, ob.blocks_);
+  std::swap(free_, ob.free_);
+  std::swap(used_, ob.used_);
+}
+
+template< typename T >
+void ivlicheva::detail::NodePool< T >::release() noexcept
+{
+  while (blocks_)
+  {
+    block_t* next = blocks_->next_;
+    operator delete(blocks_);
+    blocks_ = next;
+  }
+  free_ = nullptr;
+  used_ = 0;
+}
+
+template< typename T >
+typename ivlicheva::detail::NodePool< T >::slot_t* ivlicheva::detail::NodePool< T >::getSlots(block_t* block) const noexcept
+{
+  return reinterpret_cast< slot_t* >(reinterpret_cast< char* >(block) + getHeaderSize());
+}
+
+template< typename T >
+size_t ivlicheva::detail::NodePool< T >::getHeaderSize() noexcept
+{
+  return (sizeof(block_t) + alignof(slot_t) - 1) / alignof(slot_t) * alignof(slot_t);
+}
+
+#endif
@@ -0,0 +1,1220 @@
+#ifndef PERSISTENTTREE_H
+#define PERSISTENTTREE_H
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <initializer_list>
+
+namespace ivlicheva
+{
+  template< typename K, typename V, typename C >
+  class PersistentTree
+  {
+    public:
+      class ConstIterator;
+      class Iterator;
+      using data_t = std::pair< K, V >;
+      using this_t = PersistentTree< K, V, C >;
+
+      PersistentTree();
+      PersistentTree(const this_t&) noexcept;
+      PersistentTree(this_t&&) noexcept;
+      ~PersistentTree();
+
+      this_t& operator=(const this_t&) noexcept;
+      this_t& operator=(this_t&&) noexcept;
+
+      void swap(this_t&) noexcept;
+      void drop(const K&);
+      template< typename... Args >
+      Iterator emplace(const K&, Args&&...);
+      template< typename... Args >
+      Iterator emplace(K&&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(const K&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(K&&, Args&&...);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(const K&, M&&);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(K&&, M&&);
+      Iterator push(const K&, const V&);
+      Iterator push(K&&, V&&);
+      Iterator upperBound(const K&);
+      Iterator lowerBound(const K&);
+      Iterator find(const K&);
+      Iterator erase(Iterator);
+      void erase(Iterator, Iterator);
+      Iterator insert(const std::pair< K, V >&);
+      Iterator insert(std::pair< K, V >&&);
+      void insert(std::initializer_list< std::pair< K, V > >);
+      template< typename It >
+      void assignSorted(It, It);
+      ConstIterator upperBound(const K&) const;
+      ConstIterator lowerBound(const K&) const;
+      ConstIterator find(const K&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      void drop(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator upperBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator lowerBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator find(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator upperBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator lowerBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator find(const Q&) const;
+      bool isEmpty() const noexcept;
+      size_t size() const noexcept;
+
+      Iterator begin();
+      Iterator end();
+      ConstIterator begin() const;
+      ConstIterator end() const;
+      ConstIterator cbegin() const;
+      ConstIterator cend() const;
+
+      template< typename F >
+      F traverseLNR(F) const;
+      template< typename F >
+      F traverseRNL(F) const;
+      template< typename F >
+      F traverseBreadth(F) const;
+
+    private:
+      static constexpr size_t maxHeight = 64;
+
+      struct node_t
+      {
+        template< typename... Args >
+        node_t(Args&&...);
+
+        data_t data_;
+        node_t* left_;
+        node_t* right_;
+        size_t count_;
+        size_t height_;
+        std::atomic< size_t > refs_;
+      };
+
+      node_t* root_;
+      C cmp_;
+
+      template< typename... Args >
+      Iterator pushNode(Args&&...);
+      size_t link(node_t*);
+      static node_t* build(node_t* const*, size_t) noexcept;
+      void removeAt(size_t);
+      node_t* unsharePath(size_t);
+      ConstIterator makeIterator(size_t) const;
+      template< typename Q >
+      ConstIterator getFirstNotLess(const Q&) const;
+      template< typename Q >
+      ConstIterator getFirstGreater(const Q&) const;
+      template< typename Q >
+      ConstIterator getEqual(const Q&) const;
+      template< typename F >
+      void traverseLNR(const node_t*, F&) const;
+      template< typename F >
+      void traverseRNL(const node_t*, F&) const;
+      template< typename K1, typename K2 >
+      bool isLess(const K1&, const K2&) const;
+      static node_t* acquire(node_t*) noexcept;
+      static void release(node_t*) noexcept;
+      static node_t* unshare(node_t*);
+      static size_t getCount(const node_t*) noexcept;
+      static size_t getHeight(const node_t*) noexcept;
+      static void update(node_t*) noexcept;
+      static node_t* turnLeft(node_t*) noexcept;
+      static node_t* turnRight(node_t*) noexcept;
+      static void balance(node_t*&);
+  };
+
+  struct PersistentBackend
+  {
+    template< typename K, typename V, typename C >
+    using tree_t = PersistentTree< K, V, C >;
+  };
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::PersistentTree< K, V, C >::ConstIterator: public std::iterator< std::bidirectional_iterator_tag, std::pair< K, V > >
+{
+  public:
+    friend class PersistentTree< K, V, C >;
+    using this_t = ConstIterator;
+
+    ConstIterator();
+    ConstIterator(const this_t&) = default;
+    ~ConstIterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+    this_t& operator--();
+    this_t operator--(int);
+
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    const node_t* path_[maxHeight];
+    size_t depth_;
+    const PersistentTree< K, V, C >* tree_;
+    explicit ConstIterator(const PersistentTree< K, V, C >*);
+    void pushLeft(const node_t*);
+    void pushRight(const node_t*);
+    size_t getIndex() const;
+};
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::ConstIterator::ConstIterator():
+  depth_(0),
+  tree_(nullptr)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::ConstIterator::ConstIterator(const PersistentTree< K, V, C >* tree):
+  depth_(0),
+  tree_(tree)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator& ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator++()
+{
+  const node_t* node = path_[depth_ - 1];
+  if (node->right_)
+  {
+    pushLeft(node->right_);
+    return *this;
+  }
+  do
+  {
+    node = path_[--depth_];
+  }
+  while (depth_ && path_[depth_ - 1]->right_ == node);
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator& ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator--()
+{
+  if (!depth_)
+  {
+    pushRight(tree_->root_);
+    return *this;
+  }
+  const node_t* node = path_[depth_ - 1];
+  if (node->left_)
+  {
+    pushRight(node->left_);
+    return *this;
+  }
+  do
+  {
+    node = path_[--depth_];
+  }
+  while (depth_ && path_[depth_ - 1]->left_ == node);
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator--(int)
+{
+  this_t result(*this);
+  --(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::PersistentTree< K, V, C >::data_t& ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator*() const
+{
+  return path_[depth_ - 1]->data_;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::PersistentTree< K, V, C >::data_t* ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator->() const
+{
+  return std::addressof(path_[depth_ - 1]->data_);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator==(const this_t& iter) const
+{
+  return tree_ == iter.tree_ && depth_ == iter.depth_ && (!depth_ || path_[depth_ - 1] == iter.path_[depth_ - 1]);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::PersistentTree< K, V, C >::ConstIterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::ConstIterator::pushLeft(const node_t* node)
+{
+  while (node)
+  {
+    path_[depth_++] = node;
+    node = node->left_;
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::ConstIterator::pushRight(const node_t* node)
+{
+  while (node)
+  {
+    path_[depth_++] = node;
+    node = node->right_;
+  }
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::PersistentTree< K, V, C >::ConstIterator::getIndex() const
+{
+  if (!depth_)
+  {
+    return tree_->size();
+  }
+  size_t index = getCount(path_[depth_ - 1]->left_);
+  for (size_t i = 1; i < depth_; ++i)
+  {
+    if (path_[i - 1]->right_ == path_[i])
+    {
+      index += getCount(path_[i - 1]->left_) + 1;
+    }
+  }
+  return index;
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::PersistentTree< K, V, C >::Iterator: public std::iterator< std::bidirectional_iterator_tag, std::pair< K, V > >
+{
+  public:
+    friend class PersistentTree< K, V, C >;
+    using this_t = Iterator;
+
+    Iterator();
+    Iterator(const this_t&) = default;
+    Iterator(ConstIterator);
+    ~Iterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+    this_t& operator--();
+    this_t operator--(int);
+
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    ConstIterator citer_;
+};
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::Iterator::Iterator():
+  citer_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::Iterator::Iterator(ConstIterator citer):
+  citer_(citer)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator& ivlicheva::PersistentTree< K, V, C >::Iterator::operator++()
+{
+  ++citer_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::Iterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator& ivlicheva::PersistentTree< K, V, C >::Iterator::operator--()
+{
+  --citer_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::Iterator::operator--(int)
+{
+  this_t result(*this);
+  --(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::PersistentTree< K, V, C >::data_t& ivlicheva::PersistentTree< K, V, C >::Iterator::operator*() const
+{
+  return *citer_;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::PersistentTree< K, V, C >::data_t* ivlicheva::PersistentTree< K, V, C >::Iterator::operator->() const
+{
+  return std::addressof(*citer_);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::PersistentTree< K, V, C >::Iterator::operator==(const this_t& iter) const
+{
+  return citer_ == iter.citer_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::PersistentTree< K, V, C >::Iterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+ivlicheva::PersistentTree< K, V, C >::node_t::node_t(Args&&... args):
+  data_(std::forward< Args >(args)...),
+  left_(nullptr),
+  right_(nullptr),
+  count_(1),
+  height_(1),
+  refs_(1)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::PersistentTree():
+  root_(nullptr),
+  cmp_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::PersistentTree(const this_t& ob) noexcept:
+  root_(acquire(ob.root_)),
+  cmp_(ob.cmp_)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::PersistentTree(this_t&& ob) noexcept:
+  root_(ob.root_),
+  cmp_(ob.cmp_)
+{
+  ob.root_ = nullptr;
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >::~PersistentTree()
+{
+  release(root_);
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >& ivlicheva::PersistentTree< K, V, C >::operator=(const this_t& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    this_t tmp(ob);
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::PersistentTree< K, V, C >& ivlicheva::PersistentTree< K, V, C >::operator=(this_t&& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    this_t tmp(std::move(ob));
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::swap(this_t& ob) noexcept
+{
+  std::swap(root_, ob.root_);
+  std::swap(cmp_, ob.cmp_);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::drop(const K& k)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter != cend())
+  {
+    removeAt(iter.getIndex());
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::emplace(const K& k, Args&&... args)
+{
+  return pushNode(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward< Args >(args)...));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::emplace(K&& k, Args&&... args)
+{
+  return pushNode(std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple(std::forward< Args >(args)...));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+std::pair< typename ivlicheva::PersistentTree< K, V, C >::Iterator, bool > ivlicheva::PersistentTree< K, V, C >::tryEmplace(const K& k, Args&&... args)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter != cend())
+  {
+    return {iter, false};
+  }
+  return {emplace(k, std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+std::pair< typename ivlicheva::PersistentTree< K, V, C >::Iterator, bool > ivlicheva::PersistentTree< K, V, C >::tryEmplace(K&& k, Args&&... args)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter != cend())
+  {
+    return {iter, false};
+  }
+  return {emplace(std::move(k), std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C >
+template< typename M >
+std::pair< typename ivlicheva::PersistentTree< K, V, C >::Iterator, bool > ivlicheva::PersistentTree< K, V, C >::insertOrAssign(const K& k, M&& obj)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter == cend())
+  {
+    return {emplace(k, std::forward< M >(obj)), true};
+  }
+  size_t index = iter.getIndex();
+  unsharePath(index)->data_.second = std::forward< M >(obj);
+  return {makeIterator(index), false};
+}
+
+template< typename K, typename V, typename C >
+template< typename M >
+std::pair< typename ivlicheva::PersistentTree< K, V, C >::Iterator, bool > ivlicheva::PersistentTree< K, V, C >::insertOrAssign(K&& k, M&& obj)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter == cend())
+  {
+    return {emplace(std::move(k), std::forward< M >(obj)), true};
+  }
+  size_t index = iter.getIndex();
+  unsharePath(index)->data_.second = std::forward< M >(obj);
+  return {makeIterator(index), false};
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::push(const K& k, const V& v)
+{
+  return pushNode(k, v);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::push(K&& k, V&& v)
+{
+  return pushNode(std::move(k), std::move(v));
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::upperBound(const K& k)
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::lowerBound(const K& k)
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::find(const K& k)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter == cend())
+  {
+    return iter;
+  }
+  size_t index = iter.getIndex();
+  unsharePath(index);
+  return makeIterator(index);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::erase(Iterator iter)
+{
+  if (iter == end())
+  {
+    return end();
+  }
+  size_t index = iter.citer_.getIndex();
+  removeAt(index);
+  return makeIterator(index);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::erase(Iterator first, Iterator last)
+{
+  size_t index = first.citer_.getIndex();
+  size_t count = last.citer_.getIndex() - index;
+  if (count == size())
+  {
+    release(root_);
+    root_ = nullptr;
+    return;
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    removeAt(index);
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::insert(const std::pair< K, V >& p)
+{
+  return push(p.first, p.second);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::insert(std::pair< K, V >&& p)
+{
+  return push(std::move(p.first), std::move(p.second));
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::insert(std::initializer_list< std::pair< K, V > > il)
+{
+  for (auto&& item: il)
+  {
+    insert(item);
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename It >
+void ivlicheva::PersistentTree< K, V, C >::assignSorted(It first, It last)
+{
+  std::vector< node_t* > nodes;
+  nodes.reserve(std::distance(first, last));
+  try
+  {
+    for (; first != last; ++first)
+    {
+      nodes.push_back(new node_t(*first));
+    }
+  }
+  catch (...)
+  {
+    for (node_t* node: nodes)
+    {
+      delete node;
+    }
+    throw;
+  }
+  release(root_);
+  root_ = build(nodes.data(), nodes.size());
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::upperBound(const K& k) const
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::lowerBound(const K& k) const
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::find(const K& k) const
+{
+  return getEqual(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+void ivlicheva::PersistentTree< K, V, C >::drop(const Q& k)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter != cend())
+  {
+    removeAt(iter.getIndex());
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::upperBound(const Q& k)
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::lowerBound(const Q& k)
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::find(const Q& k)
+{
+  ConstIterator iter = getEqual(k);
+  if (iter == cend())
+  {
+    return iter;
+  }
+  size_t index = iter.getIndex();
+  unsharePath(index);
+  return makeIterator(index);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::upperBound(const Q& k) const
+{
+  return getFirstNotLess(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::lowerBound(const Q& k) const
+{
+  return getFirstGreater(k);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::find(const Q& k) const
+{
+  return getEqual(k);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::PersistentTree< K, V, C >::isEmpty() const noexcept
+{
+  return !root_;
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::PersistentTree< K, V, C >::size() const noexcept
+{
+  return getCount(root_);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::begin()
+{
+  return cbegin();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::end()
+{
+  return cend();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::begin() const
+{
+  return cbegin();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::end() const
+{
+  return cend();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::cbegin() const
+{
+  ConstIterator iter(this);
+  iter.pushLeft(root_);
+  return iter;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::cend() const
+{
+  return ConstIterator(this);
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::PersistentTree< K, V, C >::traverseLNR(F f) const
+{
+  traverseLNR(root_, f);
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::PersistentTree< K, V, C >::traverseRNL(F f) const
+{
+  traverseRNL(root_, f);
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::PersistentTree< K, V, C >::traverseBreadth(F f) const
+{
+  std::vector< const node_t* > level;
+  std::vector< const node_t* > next;
+  if (root_)
+  {
+    level.push_back(root_);
+  }
+  while (!level.empty())
+  {
+    for (const node_t* node: level)
+    {
+      f(node->data_);
+      if (node->left_)
+      {
+        next.push_back(node->left_);
+      }
+      if (node->right_)
+      {
+        next.push_back(node->right_);
+      }
+    }
+    level.swap(next);
+    next.clear();
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::PersistentTree< K, V, C >::Iterator ivlicheva::PersistentTree< K, V, C >::pushNode(Args&&... args)
+{
+  node_t* leaf = new node_t(std::forward< Args >(args)...);
+  size_t index = 0;
+  try
+  {
+    index = link(leaf);
+  }
+  catch (...)
+  {
+    delete leaf;
+    throw;
+  }
+  return makeIterator(index);
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::PersistentTree< K, V, C >::link(node_t* leaf)
+{
+  node_t** links[maxHeight];
+  node_t** link = std::addressof(root_);
+  size_t depth = 0;
+  size_t index = 0;
+  while (*link)
+  {
+    *link = unshare(*link);
+    node_t* node = *link;
+    links[depth++] = link;
+    if (isLess(leaf->data_.first, node->data_.first))
+    {
+      link = std::addressof(node->left_);
+    }
+    else
+    {
+      index += getCount(node->left_) + 1;
+      link = std::addressof(node->right_);
+    }
+  }
+  *link = leaf;
+  while (depth)
+  {
+    --depth;
+    update(*links[depth]);
+    balance(*links[depth]);
+  }
+  return index;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::node_t* ivlicheva::PersistentTree< K, V, C >::build(node_t* const* nodes, size_t count) noexcept
+{
+  if (!count)
+  {
+    return nullptr;
+  }
+  size_t middle = count / 2;
+  node_t* node = nodes[middle];
+  node->left_ = build(nodes, middle);
+  node->right_ = build(nodes + middle + 1, count - middle - 1);
+  update(node);
+  return node;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::removeAt(size_t index)
+{
+  node_t** links[maxHeight];
+  node_t** link = std::addressof(root_);
+  size_t depth = 0;
+  while (true)
+  {
+    *link = unshare(*link);
+    node_t* node = *link;
+    links[depth++] = link;
+    size_t left = getCount(node->left_);
+    if (index < left)
+    {
+      link = std::addressof(node->left_);
+    }
+    else if (index > left)
+    {
+      index -= left + 1;
+      link = std::addressof(node->right_);
+    }
+    else
+    {
+      break;
+    }
+  }
+  size_t target = depth - 1;
+  node_t* node = *links[target];
+  if (node->left_ && node->right_)
+  {
+    link = std::addressof(node->right_);
+    while (true)
+    {
+      *link = unshare(*link);
+      links[depth++] = link;
+      if (!(*link)->left_)
+      {
+        break;
+      }
+      link = std::addressof((*link)->left_);
+    }
+    node_t* next = *link;
+    *link = next->right_;
+    next->left_ = node->left_;
+    next->right_ = node->right_;
+    *links[target] = next;
+    if (depth > target + 2)
+    {
+      links[target + 1] = std::addressof(next->right_);
+    }
+  }
+  else
+  {
+    *links[target] = node->left_ ? node->left_ : node->right_;
+  }
+  node->left_ = nullptr;
+  node->right_ = nullptr;
+  release(node);
+  --depth;
+  for (size_t i = depth; i > 0; --i)
+  {
+    update(*links[i - 1]);
+  }
+  while (depth)
+  {
+    --depth;
+    update(*links[depth]);
+    balance(*links[depth]);
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::node_t* ivlicheva::PersistentTree< K, V, C >::unsharePath(size_t index)
+{
+  node_t** link = std::addressof(root_);
+  while (true)
+  {
+    *link = unshare(*link);
+    node_t* node = *link;
+    size_t left = getCount(node->left_);
+    if (index < left)
+    {
+      link = std::addressof(node->left_);
+    }
+    else if (index > left)
+    {
+      index -= left + 1;
+      link = std::addressof(node->right_);
+    }
+    else
+    {
+      return node;
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::makeIterator(size_t index) const
+{
+  ConstIterator iter(this);
+  if (index >= size())
+  {
+    return iter;
+  }
+  const node_t* node = root_;
+  while (true)
+  {
+    iter.path_[iter.depth_++] = node;
+    size_t left = getCount(node->left_);
+    if (index < left)
+    {
+      node = node->left_;
+    }
+    else if (index > left)
+    {
+      index -= left + 1;
+      node = node->right_;
+    }
+    else
+    {
+      return iter;
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::getFirstNotLess(const Q& k) const
+{
+  ConstIterator iter(this);
+  size_t result = 0;
+  const node_t* node = root_;
+  while (node)
+  {
+    iter.path_[iter.depth_++] = node;
+    if (isLess(node->data_.first, k))
+    {
+      node = node->right_;
+    }
+    else
+    {
+      result = iter.depth_;
+      node = node->left_;
+    }
+  }
+  iter.depth_ = result;
+  return iter;
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::getFirstGreater(const Q& k) const
+{
+  ConstIterator iter(this);
+  size_t result = 0;
+  const node_t* node = root_;
+  while (node)
+  {
+    iter.path_[iter.depth_++] = node;
+    if (isLess(k, node->data_.first))
+    {
+      result = iter.depth_;
+      node = node->left_;
+    }
+    else
+    {
+      node = node->right_;
+    }
+  }
+  iter.depth_ = result;
+  return iter;
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::PersistentTree< K, V, C >::ConstIterator ivlicheva::PersistentTree< K, V, C >::getEqual(const Q& k) const
+{
+  ConstIterator iter = getFirstNotLess(k);
+  if (iter != cend() && isLess(k, iter->first))
+  {
+    return cend();
+  }
+  return iter;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+void ivlicheva::PersistentTree< K, V, C >::traverseLNR(const node_t* node, F& f) const
+{
+  while (node)
+  {
+    traverseLNR(node->left_, f);
+    f(node->data_);
+    node = node->right_;
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+void ivlicheva::PersistentTree< K, V, C >::traverseRNL(const node_t* node, F& f) const
+{
+  while (node)
+  {
+    traverseRNL(node->right_, f);
+    f(node->data_);
+    node = node->left_;
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename K1, typename K2 >
+bool ivlicheva::PersistentTree< K, V, C >::isLess(const K1& k1, const K2& k2) const
+{
+  return cmp_(k1, k2);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::node_t* ivlicheva::PersistentTree< K, V, C >::acquire(node_t* node) noexcept
+{
+  if (node)
+  {
+    node->refs_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return node;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::release(node_t* node) noexcept
+{
+  while (node && node->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    release(node->left_);
+    node_t* right = node->right_;
+    delete node;
+    node = right;
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::node_t* ivlicheva::PersistentTree< K, V, C >::unshare(node_t* node)
+{
+  if (node->refs_.load(std::memory_order_acquire) == 1)
+  {
+    return node;
+  }
+  node_t* copy = new node_t(node->data_);
+  copy->left_ = acquire(node->left_);
+  copy->right_ = acquire(node->right_);
+  copy->count_ = node->count_;
+  copy->height_ = node->height_;
+  release(node);
+  return copy;
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::PersistentTree< K, V, C >::getCount(const node_t* node) noexcept
+{
+  return node ? node->count_ : 0;
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::PersistentTree< K, V, C >::getHeight(const node_t* node) noexcept
+{
+  return node ? node->height_ : 0;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::update(node_t* node) noexcept
+{
+  size_t left = getHeight(node->left_);
+  size_t right = getHeight(node->right_);
+  node->count_ = getCount(node->left_) + getCount(node->right_) + 1;
+  node->height_ = (left < right ? right : left) + 1;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::node_t* ivlicheva::PersistentTree< K, V, C >::turnLeft(node_t* node) noexcept
+{
+  node_t* right = node->right_;
+  node->right_ = right->left_;
+  right->left_ = node;
+  update(node);
+  update(right);
+  return right;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::PersistentTree< K, V, C >::node_t* ivlicheva::PersistentTree< K, V, C >::turnRight(node_t* node) noexcept
+{
+  node_t* left = node->left_;
+  node->left_ = left->right_;
+  left->right_ = node;
+  update(node);
+  update(left);
+  return left;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::PersistentTree< K, V, C >::balance(node_t*& link)
+{
+  node_t* node = link;
+  size_t left = getHeight(node->left_);
+  size_t right = getHeight(node->right_);
+  if (left > right + 1)
+  {
+    node->left_ = unshare(node->left_);
+    if (getHeight(node->left_->left_) < getHeight(node->left_->right_))
+    {
+      node->left_->right_ = unshare(node->left_->right_);
+      node->left_ = turnLeft(node->left_);
+    }
+    link = turnRight(node);
+  }
+  else if (right > left + 1)
+  {
+    node->right_ = unshare(node->right_);
+    if (getHeight(node->right_->right_) < getHeight(node->right_->left_))
+    {
+      node->right_->left_ = unshare(node->right_->left_);
+      node->right_ = turnRight(node->right_);
+    }
+    link = turnLeft(node);
+  }
+}
+
+#endif
@@ -0,0 +1,1707 @@
+#ifndef RADIXTREE_H
+#define RADIXTREE_H
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <initializer_list>
+#include <experimental/string_view>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ivlicheva
+{
+  namespace detail
+  {
+    enum class RadixNodeType: uint8_t
+    {
+      LEAF,
+      NODE4,
+      NODE16,
+      NODE48,
+      NODE256
+    };
+  }
+
+  template< typename K, typename V, typename C >
+  class RadixTree
+  {
+    public:
+      class ConstIterator;
+      class Iterator;
+      using data_t = std::pair< K, V >;
+      using this_t = RadixTree< K, V, C >;
+
+      RadixTree();
+      RadixTree(const this_t&);
+      RadixTree(this_t&&) noexcept;
+      ~RadixTree();
+
+      this_t& operator=(const this_t&);
+      this_t& operator=(this_t&&) noexcept;
+
+      void swap(this_t&) noexcept;
+      void drop(const K&);
+      template< typename... Args >
+      Iterator emplace(const K&, Args&&...);
+      template< typename... Args >
+      Iterator emplace(K&&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(const K&, Args&&...);
+      template< typename... Args >
+      std::pair< Iterator, bool > tryEmplace(K&&, Args&&...);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(const K&, M&&);
+      template< typename M >
+      std::pair< Iterator, bool > insertOrAssign(K&&, M&&);
+      Iterator push(const K&, const V&);
+      Iterator push(K&&, V&&);
+      Iterator upperBound(const K&);
+      Iterator lowerBound(const K&);
+      Iterator find(const K&);
+      Iterator erase(Iterator);
+      void erase(Iterator, Iterator);
+      Iterator insert(const std::pair< K, V >&);
+      Iterator insert(std::pair< K, V >&&);
+      void insert(std::initializer_list< std::pair< K, V > >);
+      template< typename It >
+      void assignSorted(It, It);
+      ConstIterator upperBound(const K&) const;
+      ConstIterator lowerBound(const K&) const;
+      ConstIterator find(const K&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      void drop(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator upperBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator lowerBound(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      Iterator find(const Q&);
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator upperBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator lowerBound(const Q&) const;
+      template< typename Q, typename D = C, typename = typename D::is_transparent >
+      ConstIterator find(const Q&) const;
+      bool isEmpty() const noexcept;
+      size_t size() const noexcept;
+
+      Iterator begin();
+      Iterator end();
+      ConstIterator begin() const;
+      ConstIterator end() const;
+      ConstIterator cbegin() const;
+      ConstIterator cend() const;
+
+      template< typename F >
+      F traverseLNR(F) const;
+      template< typename F >
+      F traverseRNL(F) const;
+      template< typename F >
+      F traverseBreadth(F) const;
+
+    private:
+      using key_view = std::experimental::string_view;
+      using type_t = detail::RadixNodeType;
+      static constexpr size_t maxPrefixLength = 8;
+
+      struct node_t
+      {
+        explicit node_t(type_t);
+
+        type_t type_;
+      };
+      struct leaf_t: node_t
+      {
+        template< typename... Args >
+        explicit leaf_t(Args&&...);
+
+        data_t data_;
+        leaf_t* prev_;
+        leaf_t* next_;
+      };
+      struct inner_t: node_t
+      {
+        explicit inner_t(type_t);
+
+        uint16_t count_;
+        uint32_t prefixLength_;
+        uint8_t prefix_[maxPrefixLength];
+        leaf_t* value_;
+      };
+      struct node4_t: inner_t
+      {
+        node4_t();
+
+        uint8_t keys_[4];
+        node_t* children_[4];
+      };
+      struct node16_t: inner_t
+      {
+        node16_t();
+
+        uint8_t keys_[16];
+        node_t* children_[16];
+      };
+      struct node48_t: inner_t
+      {
+        node48_t();
+
+        uint8_t index_[256];
+        node_t* children_[48];
+      };
+      struct node256_t: inner_t
+      {
+        node256_t();
+
+        node_t* children_[256];
+      };
+
+      node_t* root_;
+      leaf_t* first_;
+      leaf_t* last_;
+      size_t size_;
+
+      void destroy() noexcept;
+      void clear(node_t*) noexcept;
+      template< typename... Args >
+      Iterator pushNode(Args&&...);
+      leaf_t* pushLeaf(leaf_t*);
+      void removeLeaf(key_view);
+      void link(leaf_t*, leaf_t*) noexcept;
+      void unlink(leaf_t*) noexcept;
+      leaf_t* getEqual(key_view) const;
+      leaf_t* getFirstNotLess(key_view) const;
+      leaf_t* getFirstGreater(key_view) const;
+      template< typename Q >
+      static key_view getView(const Q&);
+      static uint8_t getByte(key_view, size_t) noexcept;
+      static bool isLeaf(const node_t*) noexcept;
+      static leaf_t* getMin(node_t*) noexcept;
+      static leaf_t* getMax(node_t*) noexcept;
+      static bool matchPrefix(const inner_t*, key_view, size_t) noexcept;
+      static size_t getMismatch(inner_t*, key_view, size_t) noexcept;
+      static uint8_t getPrefixByte(inner_t*, size_t, size_t) noexcept;
+      static void setPrefix(inner_t*, key_view, size_t, size_t) noexcept;
+      static void cutPrefix(inner_t*, size_t, size_t) noexcept;
+      static void place(inner_t*, key_view, size_t, leaf_t*) noexcept;
+      static node_t** findChild(inner_t*, uint8_t) noexcept;
+      static node_t* getChildFrom(inner_t*, size_t, uint8_t*) noexcept;
+      static node_t* getLastChild(inner_t*) noexcept;
+      static void insertChild(inner_t*, uint8_t, node_t*) noexcept;
+      static void eraseChild(inner_t*, uint8_t) noexcept;
+      static void addChild(node_t**, uint8_t, node_t*);
+      static void collapse(node_t**) noexcept;
+      static inner_t* resize(inner_t*, type_t, const std::nothrow_t&) noexcept;
+      static inner_t* resize(inner_t*, type_t);
+      static inner_t* create(type_t);
+      static inner_t* create(type_t, const std::nothrow_t&) noexcept;
+      static void copyChildren(inner_t*, inner_t*) noexcept;
+      static void deleteInner(inner_t*) noexcept;
+  };
+
+  struct RadixBackend
+  {
+    template< typename K, typename V, typename C >
+    using tree_t = RadixTree< K, V, C >;
+  };
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::RadixTree< K, V, C >::ConstIterator: public std::iterator< std::bidirectional_iterator_tag, std::pair< K, V > >
+{
+  public:
+    friend class RadixTree< K, V, C >;
+    using this_t = ConstIterator;
+
+    ConstIterator();
+    ConstIterator(const this_t&) = default;
+    ~ConstIterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+    this_t& operator--();
+    this_t operator--(int);
+
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    leaf_t* leaf_;
+    const RadixTree< K, V, C >* tree_;
+    ConstIterator(leaf_t*, const RadixTree< K, V, C >*);
+};
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::ConstIterator::ConstIterator():
+  leaf_(nullptr),
+  tree_(nullptr)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::ConstIterator::ConstIterator(leaf_t* leaf, const RadixTree< K, V, C >* tree):
+  leaf_(leaf),
+  tree_(tree)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator& ivlicheva::RadixTree< K, V, C >::ConstIterator::operator++()
+{
+  leaf_ = leaf_->next_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::ConstIterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator& ivlicheva::RadixTree< K, V, C >::ConstIterator::operator--()
+{
+  leaf_ = leaf_ ? leaf_->prev_ : tree_->last_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::ConstIterator::operator--(int)
+{
+  this_t result(*this);
+  --(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::RadixTree< K, V, C >::data_t& ivlicheva::RadixTree< K, V, C >::ConstIterator::operator*() const
+{
+  return leaf_->data_;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::RadixTree< K, V, C >::data_t* ivlicheva::RadixTree< K, V, C >::ConstIterator::operator->() const
+{
+  return std::addressof(leaf_->data_);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::ConstIterator::operator==(const this_t& iter) const
+{
+  return leaf_ == iter.leaf_ && tree_ == iter.tree_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::ConstIterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::RadixTree< K, V, C >::Iterator: public std::iterator< std::bidirectional_iterator_tag, std::pair< K, V > >
+{
+  public:
+    friend class RadixTree< K, V, C >;
+    using this_t = Iterator;
+
+    Iterator();
+    Iterator(const this_t&) = default;
+    Iterator(ConstIterator);
+    ~Iterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+    this_t& operator--();
+    this_t operator--(int);
+
+    data_t& operator*();
+    data_t* operator->();
+    const data_t& operator*() const;
+    const data_t* operator->() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    ConstIterator citer_;
+};
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::Iterator::Iterator():
+  citer_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::Iterator::Iterator(ConstIterator citer):
+  citer_(citer)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator& ivlicheva::RadixTree< K, V, C >::Iterator::operator++()
+{
+  ++citer_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::Iterator::operator++(int)
+{
+  this_t result(*this);
+  ++(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator& ivlicheva::RadixTree< K, V, C >::Iterator::operator--()
+{
+  --citer_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::Iterator::operator--(int)
+{
+  this_t result(*this);
+  --(*this);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::data_t& ivlicheva::RadixTree< K, V, C >::Iterator::operator*()
+{
+  return const_cast< data_t& >(*citer_);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::data_t* ivlicheva::RadixTree< K, V, C >::Iterator::operator->()
+{
+  return std::addressof(const_cast< data_t& >(*citer_));
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::RadixTree< K, V, C >::data_t& ivlicheva::RadixTree< K, V, C >::Iterator::operator*() const
+{
+  return *citer_;
+}
+
+template< typename K, typename V, typename C >
+const typename ivlicheva::RadixTree< K, V, C >::data_t* ivlicheva::RadixTree< K, V, C >::Iterator::operator->() const
+{
+  return std::addressof(*citer_);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::Iterator::operator==(const this_t& iter) const
+{
+  return citer_ == iter.citer_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::Iterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::node_t::node_t(type_t type):
+  type_(type)
+{}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+ivlicheva::RadixTree< K, V, C >::leaf_t::leaf_t(Args&&... args):
+  node_t(type_t::LEAF),
+  data_(std::forward< Args >(args)...),
+  prev_(nullptr),
+  next_(nullptr)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::inner_t::inner_t(type_t type):
+  node_t(type),
+  count_(0),
+  prefixLength_(0),
+  prefix_(),
+  value_(nullptr)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::node4_t::node4_t():
+  inner_t(type_t::NODE4),
+  keys_(),
+  children_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::node16_t::node16_t():
+  inner_t(type_t::NODE16),
+  keys_(),
+  children_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::node48_t::node48_t():
+  inner_t(type_t::NODE48),
+  index_(),
+  children_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::node256_t::node256_t():
+  inner_t(type_t::NODE256),
+  children_()
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::RadixTree():
+  root_(nullptr),
+  first_(nullptr),
+  last_(nullptr),
+  size_(0)
+{}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::RadixTree(const this_t& ob):
+  RadixTree()
+{
+  try
+  {
+    for (leaf_t* leaf = ob.first_; leaf; leaf = leaf->next_)
+    {
+      pushNode(leaf->data_);
+    }
+  }
+  catch (...)
+  {
+    destroy();
+    throw;
+  }
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::RadixTree(this_t&& ob) noexcept:
+  root_(ob.root_),
+  first_(ob.first_),
+  last_(ob.last_),
+  size_(ob.size_)
+{
+  ob.root_ = nullptr;
+  ob.first_ = nullptr;
+  ob.last_ = nullptr;
+  ob.size_ = 0;
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >::~RadixTree()
+{
+  destroy();
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >& ivlicheva::RadixTree< K, V, C >::operator=(const this_t& ob)
+{
+  if (this != std::addressof(ob))
+  {
+    this_t tmp(ob);
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::RadixTree< K, V, C >& ivlicheva::RadixTree< K, V, C >::operator=(this_t&& ob) noexcept
+{
+  if (this != std::addressof(ob))
+  {
+    this_t tmp(std::move(ob));
+    swap(tmp);
+  }
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::swap(this_t& ob) noexcept
+{
+  std::swap(root_, ob.root_);
+  std::swap(first_, ob.first_);
+  std::swap(last_, ob.last_);
+  std::swap(size_, ob.size_);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::drop(const K& k)
+{
+  removeLeaf(getView(k));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::emplace(const K& k, Args&&... args)
+{
+  return pushNode(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward< Args >(args)...));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::emplace(K&& k, Args&&... args)
+{
+  return pushNode(std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple(std::forward< Args >(args)...));
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+std::pair< typename ivlicheva::RadixTree< K, V, C >::Iterator, bool > ivlicheva::RadixTree< K, V, C >::tryEmplace(const K& k, Args&&... args)
+{
+  leaf_t* leaf = getEqual(getView(k));
+  if (leaf)
+  {
+    return {ConstIterator(leaf, this), false};
+  }
+  return {emplace(k, std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+std::pair< typename ivlicheva::RadixTree< K, V, C >::Iterator, bool > ivlicheva::RadixTree< K, V, C >::tryEmplace(K&& k, Args&&... args)
+{
+  leaf_t* leaf = getEqual(getView(k));
+  if (leaf)
+  {
+    return {ConstIterator(leaf, this), false};
+  }
+  return {emplace(std::move(k), std::forward< Args >(args)...), true};
+}
+
+template< typename K, typename V, typename C >
+template< typename M >
+std::pair< typename ivlicheva::RadixTree< K, V, C >::Iterator, bool > ivlicheva::RadixTree< K, V, C >::insertOrAssign(const K& k, M&& obj)
+{
+  leaf_t* leaf = getEqual(getView(k));
+  if (!leaf)
+  {
+    return {emplace(k, std::forward< M >(obj)), true};
+  }
+  leaf->data_.second = std::forward< M >(obj);
+  return {ConstIterator(leaf, this), false};
+}
+
+template< typename K, typename V, typename C >
+template< typename M >
+std::pair< typename ivlicheva::RadixTree< K, V, C >::Iterator, bool > ivlicheva::RadixTree< K, V, C >::insertOrAssign(K&& k, M&& obj)
+{
+  leaf_t* leaf = getEqual(getView(k));
+  if (!leaf)
+  {
+    return {emplace(std::move(k), std::forward< M >(obj)), true};
+  }
+  leaf->data_.second = std::forward< M >(obj);
+  return {ConstIterator(leaf, this), false};
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::push(const K& k, const V& v)
+{
+  return pushNode(k, v);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::push(K&& k, V&& v)
+{
+  return pushNode(std::move(k), std::move(v));
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::upperBound(const K& k)
+{
+  return ConstIterator(getFirstNotLess(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::lowerBound(const K& k)
+{
+  return ConstIterator(getFirstGreater(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::find(const K& k)
+{
+  return ConstIterator(getEqual(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::erase(Iterator iter)
+{
+  if (iter == end())
+  {
+    return end();
+  }
+  leaf_t* leaf = iter.citer_.leaf_;
+  ++iter;
+  removeLeaf(getView(leaf->data_.first));
+  return iter;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::erase(Iterator first, Iterator last)
+{
+  if (first == begin() && last == end())
+  {
+    destroy();
+    return;
+  }
+  while (first != last)
+  {
+    first = erase(first);
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::insert(const std::pair< K, V >& p)
+{
+  return push(p.first, p.second);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::insert(std::pair< K, V >&& p)
+{
+  return push(std::move(p.first), std::move(p.second));
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::insert(std::initializer_list< std::pair< K, V > > il)
+{
+  for (auto&& item: il)
+  {
+    insert(item);
+  }
+}
+
+template< typename K, typename V, typename C >
+template< typename It >
+void ivlicheva::RadixTree< K, V, C >::assignSorted(It first, It last)
+{
+  this_t tmp;
+  for (; first != last; ++first)
+  {
+    tmp.pushNode(*first);
+  }
+  swap(tmp);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::upperBound(const K& k) const
+{
+  return ConstIterator(getFirstNotLess(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::lowerBound(const K& k) const
+{
+  return ConstIterator(getFirstGreater(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::find(const K& k) const
+{
+  return ConstIterator(getEqual(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+void ivlicheva::RadixTree< K, V, C >::drop(const Q& k)
+{
+  removeLeaf(getView(k));
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::upperBound(const Q& k)
+{
+  return ConstIterator(getFirstNotLess(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::lowerBound(const Q& k)
+{
+  return ConstIterator(getFirstGreater(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::find(const Q& k)
+{
+  return ConstIterator(getEqual(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::upperBound(const Q& k) const
+{
+  return ConstIterator(getFirstNotLess(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::lowerBound(const Q& k) const
+{
+  return ConstIterator(getFirstGreater(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+template< typename Q, typename D, typename >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::find(const Q& k) const
+{
+  return ConstIterator(getEqual(getView(k)), this);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::isEmpty() const noexcept
+{
+  return !root_;
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::RadixTree< K, V, C >::size() const noexcept
+{
+  return size_;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::begin()
+{
+  return cbegin();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::end()
+{
+  return cend();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::begin() const
+{
+  return cbegin();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::end() const
+{
+  return cend();
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::cbegin() const
+{
+  return ConstIterator(first_, this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::ConstIterator ivlicheva::RadixTree< K, V, C >::cend() const
+{
+  return ConstIterator(nullptr, this);
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::RadixTree< K, V, C >::traverseLNR(F f) const
+{
+  for (const leaf_t* leaf = first_; leaf; leaf = leaf->next_)
+  {
+    f(leaf->data_);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::RadixTree< K, V, C >::traverseRNL(F f) const
+{
+  for (const leaf_t* leaf = last_; leaf; leaf = leaf->prev_)
+  {
+    f(leaf->data_);
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+template< typename F >
+F ivlicheva::RadixTree< K, V, C >::traverseBreadth(F f) const
+{
+  std::vector< node_t* > level;
+  std::vector< node_t* > next;
+  if (root_)
+  {
+    level.push_back(root_);
+  }
+  while (!level.empty())
+  {
+    for (node_t* node: level)
+    {
+      if (isLeaf(node))
+      {
+        f(static_cast< const leaf_t* >(node)->data_);
+        continue;
+      }
+      inner_t* inner = static_cast< inner_t* >(node);
+      if (inner->value_)
+      {
+        f(static_cast< const leaf_t* >(inner->value_)->data_);
+      }
+      uint8_t byte = 0;
+      for (node_t* child = getChildFrom(inner, 0, &byte); child; child = getChildFrom(inner, byte + 1, &byte))
+      {
+        next.push_back(child);
+      }
+    }
+    level.swap(next);
+    next.clear();
+  }
+  return f;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::destroy() noexcept
+{
+  if (root_)
+  {
+    clear(root_);
+  }
+  while (first_)
+  {
+    leaf_t* leaf = first_;
+    first_ = leaf->next_;
+    delete leaf;
+  }
+  root_ = nullptr;
+  last_ = nullptr;
+  size_ = 0;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::clear(node_t* node) noexcept
+{
+  if (isLeaf(node))
+  {
+    return;
+  }
+  inner_t* inner = static_cast< inner_t* >(node);
+  uint8_t byte = 0;
+  for (node_t* child = getChildFrom(inner, 0, &byte); child; child = getChildFrom(inner, byte + 1, &byte))
+  {
+    clear(child);
+  }
+  deleteInner(inner);
+}
+
+template< typename K, typename V, typename C >
+template< typename... Args >
+typename ivlicheva::RadixTree< K, V, C >::Iterator ivlicheva::RadixTree< K, V, C >::pushNode(Args&&... args)
+{
+  leaf_t* leaf = new leaf_t(std::forward< Args >(args)...);
+  leaf_t* result = nullptr;
+  try
+  {
+    result = pushLeaf(leaf);
+  }
+  catch (...)
+  {
+    delete leaf;
+    throw;
+  }
+  if (result != leaf)
+  {
+    delete leaf;
+  }
+  return ConstIterator(result, this);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::leaf_t* ivlicheva::RadixTree< K, V, C >::pushLeaf(leaf_t* leaf)
+{
+  key_view key = getView(leaf->data_.first);
+  node_t** ref = std::addressof(root_);
+  node_t* next = nullptr;
+  size_t depth = 0;
+  while (*ref)
+  {
+    if (isLeaf(*ref))
+    {
+      leaf_t* other = static_cast< leaf_t* >(*ref);
+      key_view otherKey = getView(other->data_.first);
+      if (otherKey == key)
+      {
+        return other;
+      }
+      size_t common = depth;
+      while (common < key.size() && common < otherKey.size() && key[common] == otherKey[common])
+      {
+        ++common;
+      }
+      inner_t* inner = create(type_t::NODE4);
+      setPrefix(inner, key, depth, common - depth);
+      place(inner, otherKey, common, other);
+      place(inner, key, common, leaf);
+      *ref = inner;
+      link(leaf, otherKey.compare(key) < 0 ? other->next_ : other);
+      ++size_;
+      return leaf;
+    }
+    inner_t* inner = static_cast< inner_t* >(*ref);
+    size_t mismatch = getMismatch(inner, key, depth);
+    if (mismatch < inner->prefixLength_)
+    {
+      inner_t* parent = create(type_t::NODE4);
+      uint8_t byte = getPrefixByte(inner, mismatch, depth);
+      bool isBefore = depth + mismatch == key.size() || getByte(key, depth + mismatch) < byte;
+      leaf_t* neighbour = isBefore ? getMin(inner) : getMax(inner)->next_;
+      setPrefix(parent, key, depth, mismatch);
+      cutPrefix(inner, mismatch + 1, depth);
+      insertChild(parent, byte, inner);
+      place(parent, key, depth + mismatch, leaf);
+      *ref = parent;
+      link(leaf, neighbour);
+      ++size_;
+      return leaf;
+    }
+    depth += inner->prefixLength_;
+    if (depth == key.size())
+    {
+      if (inner->value_)
+      {
+        return inner->value_;
+      }
+      leaf_t* neighbour = getMin(inner);
+      inner->value_ = leaf;
+      link(leaf, neighbour);
+      ++size_;
+      return leaf;
+    }
+    uint8_t byte = getByte(key, depth);
+    node_t* greater = getChildFrom(inner, byte + 1, nullptr);
+    if (greater)
+    {
+      next = greater;
+    }
+    node_t** child = findChild(inner, byte);
+    if (!child)
+    {
+      leaf_t* neighbour = getMin(next);
+      addChild(ref, byte, leaf);
+      link(leaf, neighbour);
+      ++size_;
+      return leaf;
+    }
+    ref = child;
+    ++depth;
+  }
+  *ref = leaf;
+  link(leaf, nullptr);
+  ++size_;
+  return leaf;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::removeLeaf(key_view key)
+{
+  node_t** ref = std::addressof(root_);
+  node_t** parent = nullptr;
+  uint8_t byte = 0;
+  size_t depth = 0;
+  while (*ref && !isLeaf(*ref))
+  {
+    inner_t* inner = static_cast< inner_t* >(*ref);
+    if (!matchPrefix(inner, key, depth))
+    {
+      return;
+    }
+    depth += inner->prefixLength_;
+    if (depth == key.size())
+    {
+      leaf_t* leaf = inner->value_;
+      if (!leaf || getView(leaf->data_.first) != key)
+      {
+        return;
+      }
+      inner->value_ = nullptr;
+      collapse(ref);
+      unlink(leaf);
+      delete leaf;
+      --size_;
+      return;
+    }
+    byte = getByte(key, depth);
+    node_t** child = findChild(inner, byte);
+    if (!child)
+    {
+      return;
+    }
+    parent = ref;
+    ref = child;
+    ++depth;
+  }
+  if (!*ref)
+  {
+    return;
+  }
+  leaf_t* leaf = static_cast< leaf_t* >(*ref);
+  if (getView(leaf->data_.first) != key)
+  {
+    return;
+  }
+  if (parent)
+  {
+    eraseChild(static_cast< inner_t* >(*parent), byte);
+    collapse(parent);
+  }
+  else
+  {
+    root_ = nullptr;
+  }
+  unlink(leaf);
+  delete leaf;
+  --size_;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::link(leaf_t* leaf, leaf_t* next) noexcept
+{
+  leaf->next_ = next;
+  leaf->prev_ = next ? next->prev_ : last_;
+  if (leaf->prev_)
+  {
+    leaf->prev_->next_ = leaf;
+  }
+  else
+  {
+    first_ = leaf;
+  }
+  if (next)
+  {
+    next->prev_ = leaf;
+  }
+  else
+  {
+    last_ = leaf;
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::unlink(leaf_t* leaf) noexcept
+{
+  if (leaf->prev_)
+  {
+    leaf->prev_->next_ = leaf->next_;
+  }
+  else
+  {
+    first_ = leaf->next_;
+  }
+  if (leaf->next_)
+  {
+    leaf->next_->prev_ = leaf->prev_;
+  }
+  else
+  {
+    last_ = leaf->prev_;
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::leaf_t* ivlicheva::RadixTree< K, V, C >::getEqual(key_view key) const
+{
+  node_t* node = root_;
+  size_t depth = 0;
+  while (node && !isLeaf(node))
+  {
+    inner_t* inner = static_cast< inner_t* >(node);
+    if (!matchPrefix(inner, key, depth))
+    {
+      return nullptr;
+    }
+    depth += inner->prefixLength_;
+    if (depth == key.size())
+    {
+      node = inner->value_;
+      break;
+    }
+    node_t** child = findChild(inner, getByte(key, depth));
+    node = child ? *child : nullptr;
+    ++depth;
+  }
+  leaf_t* leaf = static_cast< leaf_t* >(node);
+  return leaf && getView(leaf->data_.first) == key ? leaf : nullptr;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::leaf_t* ivlicheva::RadixTree< K, V, C >::getFirstNotLess(key_view key) const
+{
+  node_t* node = root_;
+  node_t* next = nullptr;
+  size_t depth = 0;
+  while (node)
+  {
+    if (isLeaf(node))
+    {
+      leaf_t* leaf = static_cast< leaf_t* >(node);
+      return getView(leaf->data_.first).compare(key) < 0 ? getMin(next) : leaf;
+    }
+    inner_t* inner = static_cast< inner_t* >(node);
+    size_t mismatch = getMismatch(inner, key, depth);
+    if (mismatch < inner->prefixLength_)
+    {
+      if (depth + mismatch == key.size() || getByte(key, depth + mismatch) < getPrefixByte(inner, mismatch, depth))
+      {
+        return getMin(inner);
+      }
+      return getMin(next);
+    }
+    depth += inner->prefixLength_;
+    if (depth == key.size())
+    {
+      return getMin(inner);
+    }
+    uint8_t byte = getByte(key, depth);
+    node_t* greater = getChildFrom(inner, byte + 1, nullptr);
+    if (greater)
+    {
+      next = greater;
+    }
+    node_t** child = findChild(inner, byte);
+    node = child ? *child : nullptr;
+    ++depth;
+  }
+  return getMin(next);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::leaf_t* ivlicheva::RadixTree< K, V, C >::getFirstGreater(key_view key) const
+{
+  leaf_t* leaf = getFirstNotLess(key);
+  if (leaf && getView(leaf->data_.first) == key)
+  {
+    return leaf->next_;
+  }
+  return leaf;
+}
+
+template< typename K, typename V, typename C >
+template< typename Q >
+typename ivlicheva::RadixTree< K, V, C >::key_view ivlicheva::RadixTree< K, V, C >::getView(const Q& k)
+{
+  return key_view(k);
+}
+
+template< typename K, typename V, typename C >
+uint8_t ivlicheva::RadixTree< K, V, C >::getByte(key_view key, size_t depth) noexcept
+{
+  return static_cast< uint8_t >(key[depth]);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::isLeaf(const node_t* node) noexcept
+{
+  return node->type_ == type_t::LEAF;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::leaf_t* ivlicheva::RadixTree< K, V, C >::getMin(node_t* node) noexcept
+{
+  while (node && !isLeaf(node))
+  {
+    inner_t* inner = static_cast< inner_t* >(node);
+    if (inner->value_)
+    {
+      return inner->value_;
+    }
+    node = getChildFrom(inner, 0, nullptr);
+  }
+  return static_cast< leaf_t* >(node);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::leaf_t* ivlicheva::RadixTree< K, V, C >::getMax(node_t* node) noexcept
+{
+  while (node && !isLeaf(node))
+  {
+    inner_t* inner = static_cast< inner_t* >(node);
+    node_t* child = getLastChild(inner);
+    if (!child)
+    {
+      return inner->value_;
+    }
+    node = child;
+  }
+  return static_cast< leaf_t* >(node);
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::RadixTree< K, V, C >::matchPrefix(const inner_t* inner, key_view key, size_t depth) noexcept
+{
+  if (key.size() < depth + inner->prefixLength_)
+  {
+    return false;
+  }
+  size_t stored = inner->prefixLength_ < maxPrefixLength ? inner->prefixLength_ : maxPrefixLength;
+  return !std::memcmp(inner->prefix_, key.data() + depth, stored);
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::RadixTree< K, V, C >::getMismatch(inner_t* inner, key_view key, size_t depth) noexcept
+{
+  size_t length = inner->prefixLength_;
+  size_t stored = length < maxPrefixLength ? length : maxPrefixLength;
+  size_t i = 0;
+  for (; i < stored; ++i)
+  {
+    if (depth + i == key.size() || inner->prefix_[i] != getByte(key, depth + i))
+    {
+      return i;
+    }
+  }
+  if (i < length)
+  {
+    key_view minKey = getView(getMin(inner)->data_.first);
+    for (; i < length; ++i)
+    {
+      if (depth + i == key.size() || getByte(minKey, depth + i) != getByte(key, depth + i))
+      {
+        return i;
+      }
+    }
+  }
+  return i;
+}
+
+template< typename K, typename V, typename C >
+uint8_t ivlicheva::RadixTree< K, V, C >::getPrefixByte(inner_t* inner, size_t i, size_t depth) noexcept
+{
+  if (i < maxPrefixLength)
+  {
+    return inner->prefix_[i];
+  }
+  return getByte(getView(getMin(inner)->data_.first), depth + i);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::setPrefix(inner_t* inner, key_view key, size_t depth, size_t length) noexcept
+{
+  inner->prefixLength_ = static_cast< uint32_t >(length);
+  std::memcpy(inner->prefix_, key.data() + depth, length < maxPrefixLength ? length : maxPrefixLength);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::cutPrefix(inner_t* inner, size_t cut, size_t depth) noexcept
+{
+  size_t length = inner->prefixLength_ - cut;
+  size_t stored = length < maxPrefixLength ? length : maxPrefixLength;
+  if (inner->prefixLength_ <= maxPrefixLength)
+  {
+    std::memmove(inner->prefix_, inner->prefix_ + cut, stored);
+  }
+  else
+  {
+    key_view minKey = getView(getMin(inner)->data_.first);
+    std::memcpy(inner->prefix_, minKey.data() + depth + cut, stored);
+  }
+  inner->prefixLength_ = static_cast< uint32_t >(length);
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::place(inner_t* inner, key_view key, size_t depth, leaf_t* leaf) noexcept
+{
+  if (depth == key.size())
+  {
+    inner->value_ = leaf;
+  }
+  else
+  {
+    insertChild(inner, getByte(key, depth), leaf);
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::node_t** ivlicheva::RadixTree< K, V, C >::findChild(inner_t* inner, uint8_t byte) noexcept
+{
+  switch (inner->type_)
+  {
+    case type_t::NODE4:
+    {
+      node4_t* node = static_cast< node4_t* >(inner);
+      for (size_t i = 0; i < node->count_; ++i)
+      {
+        if (node->keys_[i] == byte)
+        {
+          return std::addressof(node->children_[i]);
+        }
+      }
+      return nullptr;
+    }
+    case type_t::NODE16:
+    {
+      node16_t* node = static_cast< node16_t* >(inner);
+#if defined(__SSE2__)
+      __m128i keys = _mm_loadu_si128(reinterpret_cast< const __m128i* >(node->keys_));
+      __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast< char >(byte)), keys);
+      uint32_t mask = static_cast< uint32_t >(_mm_movemask_epi8(match)) & ((1u << node->count_) - 1);
+      return mask ? std::addressof(node->children_[__builtin_ctz(mask)]) : nullptr;
+#else
+      for (size_t i = 0; i < node->count_; ++i)
+      {
+        if (node->keys_[i] == byte)
+        {
+          return std::addressof(node->children_[i]);
+        }
+      }
+      return nullptr;
+#endif
+    }
+    case type_t::NODE48:
+    {
+      node48_t* node = static_cast< node48_t* >(inner);
+      return node->index_[byte] ? std::addressof(node->children_[node->index_[byte] - 1]) : nullptr;
+    }
+    default:
+    {
+      node256_t* node = static_cast< node256_t* >(inner);
+      return node->children_[byte] ? std::addressof(node->children_[byte]) : nullptr;
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::node_t* ivlicheva::RadixTree< K, V, C >::getChildFrom(inner_t* inner, size_t from, uint8_t* byte) noexcept
+{
+  switch (inner->type_)
+  {
+    case type_t::NODE4:
+    case type_t::NODE16:
+    {
+      const uint8_t* keys = inner->type_ == type_t::NODE4 ? static_cast< node4_t* >(inner)->keys_ : static_cast< node16_t* >(inner)->keys_;
+      node_t** children = inner->type_ == type_t::NODE4 ? static_cast< node4_t* >(inner)->children_ : static_cast< node16_t* >(inner)->children_;
+      for (size_t i = 0; i < inner->count_; ++i)
+      {
+        if (keys[i] >= from)
+        {
+          if (byte)
+          {
+            *byte = keys[i];
+          }
+          return children[i];
+        }
+      }
+      return nullptr;
+    }
+    case type_t::NODE48:
+    {
+      node48_t* node = static_cast< node48_t* >(inner);
+      for (size_t i = from; i < 256; ++i)
+      {
+        if (node->index_[i])
+        {
+          if (byte)
+          {
+            *byte = static_cast< uint8_t >(i);
+          }
+          return node->children_[node->index_[i] - 1];
+        }
+      }
+      return nullptr;
+    }
+    default:
+    {
+      node256_t* node = static_cast< node256_t* >(inner);
+      for (size_t i = from; i < 256; ++i)
+      {
+        if (node->children_[i])
+        {
+          if (byte)
+          {
+            *byte = static_cast< uint8_t >(i);
+          }
+          return node->children_[i];
+        }
+      }
+      return nullptr;
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::node_t* ivlicheva::RadixTree< K, V, C >::getLastChild(inner_t* inner) noexcept
+{
+  switch (inner->type_)
+  {
+    case type_t::NODE4:
+      return inner->count_ ? static_cast< node4_t* >(inner)->children_[inner->count_ - 1] : nullptr;
+    case type_t::NODE16:
+      return inner->count_ ? static_cast< node16_t* >(inner)->children_[inner->count_ - 1] : nullptr;
+    case type_t::NODE48:
+    {
+      node48_t* node = static_cast< node48_t* >(inner);
+      for (size_t i = 256; i--;)
+      {
+        if (node->index_[i])
+        {
+          return node->children_[node->index_[i] - 1];
+        }
+      }
+      return nullptr;
+    }
+    default:
+    {
+      node256_t* node = static_cast< node256_t* >(inner);
+      for (size_t i = 256; i--;)
+      {
+        if (node->children_[i])
+        {
+          return node->children_[i];
+        }
+      }
+      return nullptr;
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::insertChild(inner_t* inner, uint8_t byte, node_t* child) noexcept
+{
+  switch (inner->type_)
+  {
+    case type_t::NODE4:
+    case type_t::NODE16:
+    {
+      uint8_t* keys = inner->type_ == type_t::NODE4 ? static_cast< node4_t* >(inner)->keys_ : static_cast< node16_t* >(inner)->keys_;
+      node_t** children = inner->type_ == type_t::NODE4 ? static_cast< node4_t* >(inner)->children_ : static_cast< node16_t* >(inner)->children_;
+      size_t i = inner->count_;
+      for (; i && keys[i - 1] > byte; --i)
+      {
+        keys[i] = keys[i - 1];
+        children[i] = children[i - 1];
+      }
+      keys[i] = byte;
+      children[i] = child;
+      break;
+    }
+    case type_t::NODE48:
+    {
+      node48_t* node = static_cast< node48_t* >(inner);
+      size_t slot = 0;
+      while (node->children_[slot])
+      {
+        ++slot;
+      }
+      node->children_[slot] = child;
+      node->index_[byte] = static_cast< uint8_t >(slot + 1);
+      break;
+    }
+    default:
+      static_cast< node256_t* >(inner)->children_[byte] = child;
+      break;
+  }
+  ++inner->count_;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::eraseChild(inner_t* inner, uint8_t byte) noexcept
+{
+  switch (inner->type_)
+  {
+    case type_t::NODE4:
+    case type_t::NODE16:
+    {
+      uint8_t* keys = inner->type_ == type_t::NODE4 ? static_cast< node4_t* >(inner)->keys_ : static_cast< node16_t* >(inner)->keys_;
+      node_t** children = inner->type_ == type_t::NODE4 ? static_cast< node4_t* >(inner)->children_ : static_cast< node16_t* >(inner)->children_;
+      size_t i = 0;
+      while (keys[i] != byte)
+      {
+        ++i;
+      }
+      for (; i + 1 < inner->count_; ++i)
+      {
+        keys[i] = keys[i + 1];
+        children[i] = children[i + 1];
+      }
+      keys[i] = 0;
+      children[i] = nullptr;
+      break;
+    }
+    case type_t::NODE48:
+    {
+      node48_t* node = static_cast< node48_t* >(inner);
+      node->children_[node->index_[byte] - 1] = nullptr;
+      node->index_[byte] = 0;
+      break;
+    }
+    default:
+      static_cast< node256_t* >(inner)->children_[byte] = nullptr;
+      break;
+  }
+  --inner->count_;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::addChild(node_t** ref, uint8_t byte, node_t* child)
+{
+  inner_t* inner = static_cast< inner_t* >(*ref);
+  if (inner->type_ == type_t::NODE4 && inner->count_ == 4)
+  {
+    inner = resize(inner, type_t::NODE16);
+  }
+  else if (inner->type_ == type_t::NODE16 && inner->count_ == 16)
+  {
+    inner = resize(inner, type_t::NODE48);
+  }
+  else if (inner->type_ == type_t::NODE48 && inner->count_ == 48)
+  {
+    inner = resize(inner, type_t::NODE256);
+  }
+  insertChild(inner, byte, child);
+  *ref = inner;
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::collapse(node_t** ref) noexcept
+{
+  inner_t* inner = static_cast< inner_t* >(*ref);
+  if (inner->type_ == type_t::NODE256 && inner->count_ <= 37)
+  {
+    inner = resize(inner, type_t::NODE48, std::nothrow);
+  }
+  else if (inner->type_ == type_t::NODE48 && inner->count_ <= 12)
+  {
+    inner = resize(inner, type_t::NODE16, std::nothrow);
+  }
+  else if (inner->type_ == type_t::NODE16 && inner->count_ <= 3)
+  {
+    inner = resize(inner, type_t::NODE4, std::nothrow);
+  }
+  *ref = inner;
+  if (!inner->count_)
+  {
+    *ref = inner->value_;
+    deleteInner(inner);
+    return;
+  }
+  if (inner->count_ > 1 || inner->value_)
+  {
+    return;
+  }
+  uint8_t byte = 0;
+  node_t* child = getChildFrom(inner, 0, &byte);
+  if (!isLeaf(child))
+  {
+    inner_t* next = static_cast< inner_t* >(child);
+    uint8_t prefix[maxPrefixLength] = {};
+    size_t length = inner->prefixLength_ < maxPrefixLength ? inner->prefixLength_ : maxPrefixLength;
+    std::memcpy(prefix, inner->prefix_, length);
+    if (length < maxPrefixLength)
+    {
+      prefix[length++] = byte;
+    }
+    size_t rest = next->prefixLength_ < maxPrefixLength - length ? next->prefixLength_ : maxPrefixLength - length;
+    std::memcpy(prefix + length, next->prefix_, rest);
+    std::memcpy(next->prefix_, prefix, maxPrefixLength);
+    next->prefixLength_ += inner->prefixLength_ + 1;
+  }
+  *ref = child;
+  deleteInner(inner);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::inner_t* ivlicheva::RadixTree< K, V, C >::resize(inner_t* inner, type_t type, const std::nothrow_t&) noexcept
+{
+  inner_t* result = create(type, std::nothrow);
+  if (!result)
+  {
+    return inner;
+  }
+  copyChildren(inner, result);
+  deleteInner(inner);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::inner_t* ivlicheva::RadixTree< K, V, C >::resize(inner_t* inner, type_t type)
+{
+  inner_t* result = create(type);
+  copyChildren(inner, result);
+  deleteInner(inner);
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::inner_t* ivlicheva::RadixTree< K, V, C >::create(type_t type)
+{
+  inner_t* result = create(type, std::nothrow);
+  if (!result)
+  {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::RadixTree< K, V, C >::inner_t* ivlicheva::RadixTree< K, V, C >::create(type_t type, const std::nothrow_t&) noexcept
+{
+  switch (type)
+  {
+    case type_t::NODE4:
+      return new (std::nothrow) node4_t();
+    case type_t::NODE16:
+      return new (std::nothrow) node16_t();
+    case type_t::NODE48:
+      return new (std::nothrow) node48_t();
+    default:
+      return new (std::nothrow) node256_t();
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::copyChildren(inner_t* from, inner_t* to) noexcept
+{
+  to->prefixLength_ = from->prefixLength_;
+  std::memcpy(to->prefix_, from->prefix_, maxPrefixLength);
+  to->value_ = from->value_;
+  uint8_t byte = 0;
+  for (node_t* child = getChildFrom(from, 0, &byte); child; child = getChildFrom(from, byte + 1, &byte))
+  {
+    insertChild(to, byte, child);
+  }
+}
+
+template< typename K, typename V, typename C >
+void ivlicheva::RadixTree< K, V, C >::deleteInner(inner_t* inner) noexcept
+{
+  switch (inner->type_)
+  {
+    case type_t::NODE4:
+      delete static_cast< node4_t* >(inner);
+      break;
+    case type_t::NODE16:
+      delete static_cast< node16_t* >(inner);
+      break;
+    case type_t::NODE48:
+      delete static_cast< node48_t* >(inner);
+      break;
+    default:
+      delete static_cast< node256_t* >(inner);
+      break;
+  }
+}
+
+#endif
@@ -0,0 +1,551 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <experimental/string_view>
+#include "MappedFile.h"
+
+namespace ivlicheva
+{
+  namespace detail
+  {
+    constexpr char snapshotMagic[8] = {'I', 'V', 'L', 'S', 'N', 'A', 'P', '\0'};
+    constexpr uint32_t snapshotVersion = 1;
+
+    struct SnapshotHeader
+    {
+      char magic_[8];
+      uint32_t version_;
+      uint32_t keyTag_;
+      uint32_t valueTag_;
+      uint32_t sectionCount_;
+      uint64_t pool_;
+      uint64_t poolSize_;
+      uint64_t bodySize_;
+      uint64_t checksum_;
+    };
+
+    struct SnapshotSection
+    {
+      uint64_t name_;
+      uint64_t nameSize_;
+      uint64_t count_;
+      uint64_t keys_;
+      uint64_t values_;
+    };
+
+    struct SnapshotString
+    {
+      uint64_t offset_;
+      uint64_t size_;
+    };
+
+    template< typename T, typename = void >
+    struct SnapshotField;
+
+    template< typename T >
+    struct SnapshotField< T, typename std::enable_if< std::is_arithmetic< T >::value >::type >
+    {
+      using stored_t = T;
+      using view_t = T;
+      static constexpr uint32_t tag = sizeof(T) | (std::is_signed< T >::value ? 0x10 : 0) | (std::is_floating_point< T >::value ? 0x20 : 0);
+      static stored_t store(const T& value, std::string&)
+      {
+        return value;
+      }
+      static view_t view(const stored_t& value, const char*, size_t)
+      {
+        return value;
+      }
+    };
+
+    template<>
+    struct SnapshotField< std::string >
+    {
+      using stored_t = SnapshotString;
+      using view_t = std::experimental::string_view;
+      static constexpr uint32_t tag = 0x100;
+      static stored_t store(const std::string& value, std::string& pool)
+      {
+        stored_t result{pool.size(), value.size()};
+        pool.append(value);
+        return result;
+      }
+      static view_t view(const stored_t& value, const char* pool, size_t poolSize)
+      {
+        if (value.offset_ > poolSize || value.size_ > poolSize - value.offset_)
+        {
+          throw std::logic_error("Bad snapshot");
+        }
+        return view_t(pool + value.offset_, value.size_);
+      }
+    };
+
+    class SnapshotChecksum
+    {
+      public:
+        SnapshotChecksum() noexcept;
+        void update(const char*, size_t) noexcept;
+        uint64_t get() const noexcept;
+
+      private:
+        uint64_t value_;
+        void mix(uint64_t) noexcept;
+    };
+
+    inline SnapshotChecksum::SnapshotChecksum() noexcept:
+      value_(0xcbf29ce484222325)
+    {}
+
+    inline void SnapshotChecksum::update(const char* data, size_t size) noexcept
+    {
+      uint64_t word = 0;
+      for (; size >= sizeof(word); data += sizeof(word), size -= sizeof(word))
+      {
+        std::memcpy(std::addressof(word), data, sizeof(word));
+        mix(word);
+      }
+      if (size)
+      {
+        word = 0;
+        std::memcpy(std::addressof(word), data, size);
+        mix(word);
+      }
+    }
+
+    inline uint64_t SnapshotChecksum::get() const noexcept
+    {
+      return value_;
+    }
+
+    inline void SnapshotChecksum::mix(uint64_t word) noexcept
+    {
+      value_ ^= word * 0x9e3779b97f4a7c15;
+      value_ = ((value_ << 27) | (value_ >> 37)) * 0xff51afd7ed558ccd;
+    }
+
+    inline size_t alignSnapshot(size_t size) noexcept
+    {
+      return (size + 7) & ~static_cast< size_t >(7);
+    }
+  }
+
+  template< typename K, typename V >
+  class SnapshotWriter
+  {
+    public:
+      SnapshotWriter() = default;
+
+      template< typename It >
+      void addSection(const std::string&, It, It);
+      void save(const std::string&) const;
+
+    private:
+      using key_field_t = detail::SnapshotField< K >;
+      using value_field_t = detail::SnapshotField< V >;
+      struct section_t
+      {
+        detail::SnapshotString name_;
+        std::vector< typename key_field_t::stored_t > keys_;
+        std::vector< typename value_field_t::stored_t > values_;
+      };
+
+      std::vector< section_t > sections_;
+      std::string pool_;
+
+      static void write(std::ofstream&, detail::SnapshotChecksum&, const char*, size_t);
+  };
+
+  template< typename K, typename V, typename C >
+  class Snapshot
+  {
+    public:
+      class View;
+      using name_t = std::experimental::string_view;
+
+      explicit Snapshot(const std::string&);
+      Snapshot(const Snapshot&) = delete;
+      Snapshot(Snapshot&&) noexcept = default;
+      ~Snapshot() = default;
+
+      Snapshot& operator=(const Snapshot&) = delete;
+      Snapshot& operator=(Snapshot&&) noexcept = default;
+
+      size_t getSectionCount() const noexcept;
+      name_t getName(size_t) const;
+      View getSection(size_t) const;
+      View getSection(name_t) const;
+
+    private:
+      MappedFile file_;
+      const detail::SnapshotHeader* header_;
+      const detail::SnapshotSection* sections_;
+      const char* pool_;
+  };
+
+  bool isSnapshot(const std::string&);
+}
+
+template< typename K, typename V, typename C >
+class ivlicheva::Snapshot< K, V, C >::View
+{
+  public:
+    friend class Snapshot< K, V, C >;
+    class ConstIterator;
+    using key_view_t = typename detail::SnapshotField< K >::view_t;
+    using value_view_t = typename detail::SnapshotField< V >::view_t;
+    using data_t = std::pair< key_view_t, value_view_t >;
+
+    View(const View&) = default;
+    ~View() = default;
+
+    View& operator=(const View&) = default;
+
+    size_t size() const noexcept;
+    bool isEmpty() const noexcept;
+    key_view_t getKey(size_t) const;
+    value_view_t getValue(size_t) const;
+    size_t upperBound(const K&) const;
+    value_view_t get(const K&) const;
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+  private:
+    using key_stored_t = typename detail::SnapshotField< K >::stored_t;
+    using value_stored_t = typename detail::SnapshotField< V >::stored_t;
+
+    const key_stored_t* keys_;
+    const value_stored_t* values_;
+    size_t count_;
+    const char* pool_;
+    size_t poolSize_;
+    C cmp_;
+    View(const key_stored_t*, const value_stored_t*, size_t, const char*, size_t);
+};
+
+template< typename K, typename V, typename C >
+class ivlicheva::Snapshot< K, V, C >::View::ConstIterator: public std::iterator< std::forward_iterator_tag, data_t, std::ptrdiff_t, void, data_t >
+{
+  public:
+    friend class View;
+    using this_t = ConstIterator;
+
+    ConstIterator(const this_t&) = default;
+    ~ConstIterator() = default;
+
+    this_t& operator=(const this_t&) = default;
+    this_t& operator++();
+    this_t operator++(int);
+
+    data_t operator*() const;
+
+    bool operator!=(const this_t&) const;
+    bool operator==(const this_t&) const;
+
+  private:
+    const View* view_;
+    size_t index_;
+    ConstIterator(const View*, size_t);
+};
+
+template< typename K, typename V >
+template< typename It >
+void ivlicheva::SnapshotWriter< K, V >::addSection(const std::string& name, It first, It last)
+{
+  section_t section;
+  section.name_ = detail::SnapshotField< std::string >::store(name, pool_);
+  for (; first != last; ++first)
+  {
+    section.keys_.push_back(key_field_t::store(first->first, pool_));
+    section.values_.push_back(value_field_t::store(first->second, pool_));
+  }
+  sections_.push_back(std::move(section));
+}
+
+template< typename K, typename V >
+void ivlicheva::SnapshotWriter< K, V >::save(const std::string& path) const
+{
+  using key_stored_t = typename key_field_t::stored_t;
+  using value_stored_t = typename value_field_t::stored_t;
+  std::vector< detail::SnapshotSection > table;
+  size_t offset = sizeof(detail::SnapshotHeader) + sections_.size() * sizeof(detail::SnapshotSection);
+  for (const section_t& section: sections_)
+  {
+    size_t count = section.keys_.size();
+    detail::SnapshotSection item{section.name_.offset_, section.name_.size_, count, offset, 0};
+    offset += detail::alignSnapshot(count * sizeof(key_stored_t));
+    item.values_ = offset;
+    offset += detail::alignSnapshot(count * sizeof(value_stored_t));
+    table.push_back(item);
+  }
+  detail::SnapshotHeader header{{}, detail::snapshotVersion, key_field_t::tag, value_field_t::tag, static_cast< uint32_t >(sections_.size()), offset, pool_.size(), 0, 0};
+  std::memcpy(header.magic_, detail::snapshotMagic, sizeof(header.magic_));
+  header.bodySize_ = offset + detail::alignSnapshot(pool_.size()) - sizeof(header);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    throw std::logic_error("Bad file");
+  }
+  detail::SnapshotChecksum checksum;
+  file.write(reinterpret_cast< const char* >(std::addressof(header)), sizeof(header));
+  write(file, checksum, reinterpret_cast< const char* >(table.data()), table.size() * sizeof(detail::SnapshotSection));
+  for (const section_t& section: sections_)
+  {
+    write(file, checksum, reinterpret_cast< const char* >(section.keys_.data()), section.keys_.size() * sizeof(key_stored_t));
+    write(file, checksum, reinterpret_cast< const char* >(section.values_.data()), section.values_.size() * sizeof(value_stored_t));
+  }
+  write(file, checksum, pool_.data(), pool_.size());
+  header.checksum_ = checksum.get();
+  file.seekp(0);
+  file.write(reinterpret_cast< const char* >(std::addressof(header)), sizeof(header));
+  file.close();
+  if (!file)
+  {
+    throw std::logic_error("Bad file");
+  }
+}
+
+template< typename K, typename V >
+void ivlicheva::SnapshotWriter< K, V >::write(std::ofstream& file, detail::SnapshotChecksum& checksum, const char* data, size_t size)
+{
+  static const char padding[8] = {};
+  checksum.update(data, size);
+  file.write(data, size);
+  file.write(padding, detail::alignSnapshot(size) - size);
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::Snapshot< K, V, C >::Snapshot(const std::string& path):
+  file_(path),
+  header_(nullptr),
+  sections_(nullptr),
+  pool_(nullptr)
+{
+  using key_stored_t = typename detail::SnapshotField< K >::stored_t;
+  using value_stored_t = typename detail::SnapshotField< V >::stored_t;
+  const char* data = file_.data();
+  size_t size = file_.size();
+  if (size < sizeof(detail::SnapshotHeader))
+  {
+    throw std::logic_error("Bad snapshot");
+  }
+  header_ = reinterpret_cast< const detail::SnapshotHeader* >(data);
+  if (std::memcmp(header_->magic_, detail::snapshotMagic, sizeof(header_->magic_)) != 0 || header_->version_ != detail::snapshotVersion)
+  {
+    throw std::logic_error("Bad snapshot");
+  }
+  if (header_->keyTag_ != detail::SnapshotField< K >::tag || header_->valueTag_ != detail::SnapshotField< V >::tag)
+  {
+    throw std::logic_error("Bad snapshot");
+  }
+  if (header_->bodySize_ != size - sizeof(detail::SnapshotHeader) || header_->pool_ < sizeof(detail::SnapshotHeader) || header_->pool_ > size || header_->poolSize_ > size - header_->pool_)
+  {
+    throw std::logic_error("Bad snapshot");
+  }
+  detail::SnapshotChecksum checksum;
+  checksum.update(data + sizeof(detail::SnapshotHeader), header_->bodySize_);
+  if (checksum.get() != header_->checksum_)
+  {
+    throw std::logic_error("Bad snapshot");
+  }
+  sections_ = reinterpret_cast< const detail::SnapshotSection* >(data + sizeof(detail::SnapshotHeader));
+  pool_ = data + header_->pool_;
+  if (header_->sectionCount_ > (header_->pool_ - sizeof(detail::SnapshotHeader)) / sizeof(detail::SnapshotSection))
+  {
+    throw std::logic_error("Bad snapshot");
+  }
+  for (size_t i = 0; i < header_->sectionCount_; ++i)
+  {
+    const detail::SnapshotSection& section = sections_[i];
+    uint64_t count = section.count_;
+    if (section.keys_ % 8 || section.values_ % 8 || section.keys_ > header_->pool_ || section.values_ > header_->pool_)
+    {
+      throw std::logic_error("Bad snapshot");
+    }
+    if (count > (header_->pool_ - section.keys_) / sizeof(key_stored_t) || count > (header_->pool_ - section.values_) / sizeof(value_stored_t))
+    {
+      throw std::logic_error("Bad snapshot");
+    }
+  }
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::Snapshot< K, V, C >::getSectionCount() const noexcept
+{
+  return header_->sectionCount_;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::name_t ivlicheva::Snapshot< K, V, C >::getName(size_t index) const
+{
+  if (index >= getSectionCount())
+  {
+    throw std::logic_error("Error in get");
+  }
+  detail::SnapshotString name{sections_[index].name_, sections_[index].nameSize_};
+  return detail::SnapshotField< std::string >::view(name, pool_, header_->poolSize_);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View ivlicheva::Snapshot< K, V, C >::getSection(size_t index) const
+{
+  using key_stored_t = typename detail::SnapshotField< K >::stored_t;
+  using value_stored_t = typename detail::SnapshotField< V >::stored_t;
+  if (index >= getSectionCount())
+  {
+    throw std::logic_error("Error in get");
+  }
+  const detail::SnapshotSection& section = sections_[index];
+  const char* data = file_.data();
+  return View(reinterpret_cast< const key_stored_t* >(data + section.keys_), reinterpret_cast< const value_stored_t* >(data + section.values_), section.count_, pool_, header_->poolSize_);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View ivlicheva::Snapshot< K, V, C >::getSection(name_t name) const
+{
+  for (size_t i = 0; i < getSectionCount(); ++i)
+  {
+    if (getName(i) == name)
+    {
+      return getSection(i);
+    }
+  }
+  throw std::logic_error("Error in get");
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::Snapshot< K, V, C >::View::View(const key_stored_t* keys, const value_stored_t* values, size_t count, const char* pool, size_t poolSize):
+  keys_(keys),
+  values_(values),
+  count_(count),
+  pool_(pool),
+  poolSize_(poolSize),
+  cmp_()
+{}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::Snapshot< K, V, C >::View::size() const noexcept
+{
+  return count_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::Snapshot< K, V, C >::View::isEmpty() const noexcept
+{
+  return !count_;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::key_view_t ivlicheva::Snapshot< K, V, C >::View::getKey(size_t index) const
+{
+  return detail::SnapshotField< K >::view(keys_[index], pool_, poolSize_);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::value_view_t ivlicheva::Snapshot< K, V, C >::View::getValue(size_t index) const
+{
+  return detail::SnapshotField< V >::view(values_[index], pool_, poolSize_);
+}
+
+template< typename K, typename V, typename C >
+size_t ivlicheva::Snapshot< K, V, C >::View::upperBound(const K& k) const
+{
+  size_t first = 0;
+  size_t count = count_;
+  while (count)
+  {
+    size_t half = count / 2;
+    if (cmp_(getKey(first + half), k))
+    {
+      first += half + 1;
+      count -= half + 1;
+    }
+    else
+    {
+      count = half;
+    }
+  }
+  return first;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::value_view_t ivlicheva::Snapshot< K, V, C >::View::get(const K& k) const
+{
+  size_t index = upperBound(k);
+  if (index == count_ || cmp_(k, getKey(index)))
+  {
+    throw std::logic_error("Error in get");
+  }
+  return getValue(index);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::ConstIterator ivlicheva::Snapshot< K, V, C >::View::begin() const
+{
+  return ConstIterator(this, 0);
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::ConstIterator ivlicheva::Snapshot< K, V, C >::View::end() const
+{
+  return ConstIterator(this, count_);
+}
+
+template< typename K, typename V, typename C >
+ivlicheva::Snapshot< K, V, C >::View::ConstIterator::ConstIterator(const View* view, size_t index):
+  view_(view),
+  index_(index)
+{}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::ConstIterator& ivlicheva::Snapshot< K, V, C >::View::ConstIterator::operator++()
+{
+  ++index_;
+  return *this;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::ConstIterator ivlicheva::Snapshot< K, V, C >::View::ConstIterator::operator++(int)
+{
+  this_t result(*this);
+  ++index_;
+  return result;
+}
+
+template< typename K, typename V, typename C >
+typename ivlicheva::Snapshot< K, V, C >::View::data_t ivlicheva::Snapshot< K, V, C >::View::ConstIterator::operator*() const
+{
+  return data_t(view_->getKey(index_), view_->getValue(index_));
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::Snapshot< K, V, C >::View::ConstIterator::operator==(const this_t& iter) const
+{
+  return view_ == iter.view_ && index_ == iter.index_;
+}
+
+template< typename K, typename V, typename C >
+bool ivlicheva::Snapshot< K, V, C >::View::ConstIterator::operator!=(const this_t& iter) const
+{
+  return !(*this == iter);
+}
+
+inline bool ivlicheva::isSnapshot(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(detail::snapshotMagic)] = {};
+  file.read(magic, sizeof(magic));
+  return file && std::memcmp(magic, detail::snapshotMagic, sizeof(magic)) == 0;
+}
+
+#endif